@@ -0,0 +1,113 @@
+#include "Animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "lerp.hpp"
+
+namespace
+{
+	// Values a transform or camera starts from, in the order its key takes them
+	std::vector<double> initialValues(const SceneGraph& scene, std::size_t node)
+	{
+		if (scene.nodes()[node].type == SceneGraph::NodeType::Camera)
+		{
+			auto& params = scene.cameraParams(node);
+			return { params.xLow, params.yLow, params.xHigh, params.yHigh, params.near, params.far };
+		}
+
+		auto& command = scene.transformCommand(node);
+		if (command.operation() == Command::Operation::Rotate)
+		{
+			return { std::get<RotateParams>(command.parameters()).second };
+		}
+
+		auto& params = std::get<Vector3>(command.parameters());
+		return { params.begin(), params.end() };
+	}
+}
+
+Animation::Animation(const SceneGraph& scene)
+{
+	for (auto& [node, key] : scene.keyframes())
+	{
+		auto track = std::find_if(tracks.begin(), tracks.end(), [node = node](const Track& t) { return t.node == node; });
+		if (track == tracks.end())
+		{
+			tracks.push_back(Track{ node, { Key_t{ 0.0, initialValues(scene, node) } } });
+			track = std::prev(tracks.end());
+		}
+
+		if (key.values.size() != track->keys.front().second.size())
+		{
+			throw std::invalid_argument("A key needs as many values as the command it animates");
+		}
+		track->keys.emplace_back(key.frame, key.values);
+		_frameCount = std::max(_frameCount, static_cast<int>(std::floor(key.frame)) + 1);
+	}
+
+	for (auto& track : tracks)
+	{
+		std::stable_sort(track.keys.begin(), track.keys.end(), [](const Key_t& a, const Key_t& b) { return a.first < b.first; });
+	}
+}
+
+void Animation::pose(SceneGraph& scene, double frame) const
+{
+	for (auto& track : tracks)
+	{
+		auto values = sample(track.keys, frame);
+		if (scene.nodes()[track.node].type == SceneGraph::NodeType::Camera)
+		{
+			scene.setCameraParams(track.node, CameraParams{ values[0], values[1], values[2], values[3], values[4], values[5] });
+			continue;
+		}
+
+		auto& command = scene.transformCommand(track.node);
+		switch (command.operation())
+		{
+			case Command::Operation::Scale:
+			{
+				scene.setTransform(track.node, SceneGraph::scaleMatrix(Vector3{ values[0], values[1], values[2] }));
+			} break;
+
+			case Command::Operation::Translate:
+			{
+				scene.setTransform(track.node, SceneGraph::translateMatrix(Vector3{ values[0], values[1], values[2] }));
+			} break;
+
+			case Command::Operation::Rotate:
+			default:
+			{
+				scene.setTransform(track.node, SceneGraph::rotateMatrix(std::get<RotateParams>(command.parameters()).first, values[0]));
+			} break;
+		}
+	}
+
+	scene.update();
+}
+
+std::vector<double> Animation::sample(const std::vector<Key_t>& keys, double frame)
+{
+	auto next = std::upper_bound(keys.begin(), keys.end(), frame, [](double f, const Key_t& key) { return f < key.first; });
+	if (next == keys.begin())
+	{
+		return next->second;
+	}
+	if (next == keys.end())
+	{
+		return keys.back().second;
+	}
+
+	auto& [startFrame, start] = *std::prev(next);
+	auto& [endFrame, end] = *next;
+	auto step = (frame - startFrame) / (endFrame - startFrame);
+
+	std::vector<double> values(start.size());
+	for (auto i = 0u; i < values.size(); ++i)
+	{
+		values[i] = Lerp<double>::lerp(start[i], end[i], step);
+	}
+	return values;
+}
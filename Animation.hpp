@@ -0,0 +1,39 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+#include "SceneGraph.hpp"
+
+// Keyframed transforms and cameras of a scene graph. A key command gives the
+// values of the transform or camera right before it at some frame, the
+// command itself is the key at frame 0. Between keys values are interpolated
+// linearly, before the first and after the last key they hold.
+class Animation
+{
+public:
+	explicit Animation(const SceneGraph& scene);
+
+	// One past the last keyed frame, 1 for a still scene
+	int frameCount() const
+	{
+		return _frameCount;
+	}
+
+	// Sets every animated node of scene to its value at frame and updates the world matrices
+	void pose(SceneGraph& scene, double frame) const;
+
+private:
+	using Key_t = std::pair<double, std::vector<double>>;
+
+	struct Track
+	{
+		std::size_t node;
+		// Sorted by frame
+		std::vector<Key_t> keys;
+	};
+
+	static std::vector<double> sample(const std::vector<Key_t>& keys, double frame);
+
+	std::vector<Track> tracks;
+	int _frameCount = 1;
+};
@@ -0,0 +1,118 @@
+#include "Arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+Arena::Arena(std::size_t blockSize, std::size_t retainedSize) : _blockSize(blockSize), _retainedSize(retainedSize)
+{
+}
+
+Arena::Arena(const Arena& other) : _blockSize(other._blockSize), _retainedSize(other._retainedSize)
+{
+}
+
+Arena& Arena::operator=(const Arena& other)
+{
+	if (this != &other)
+	{
+		blocks.clear();
+		currentBlock = 0;
+		currentOffset = 0;
+		_blockSize = other._blockSize;
+		_retainedSize = other._retainedSize;
+	}
+	return *this;
+}
+
+void* Arena::allocate(std::size_t size, std::size_t alignment)
+{
+	while (currentBlock < blocks.size())
+	{
+		auto& block = blocks[currentBlock];
+		auto base = reinterpret_cast<std::uintptr_t>(block.data.get());
+		auto alignedOffset = ((base + currentOffset + alignment - 1) & ~(alignment - 1)) - base;
+		if (alignedOffset + size <= block.size)
+		{
+			currentOffset = alignedOffset + size;
+			return block.data.get() + alignedOffset;
+		}
+
+		// Does not fit, move on to the next block
+		++currentBlock;
+		currentOffset = 0;
+	}
+
+	auto blockSize = std::max(_blockSize, size + alignment);
+	blocks.push_back(Block{ std::make_unique<std::byte[]>(blockSize), blockSize });
+	currentBlock = blocks.size() - 1;
+	currentOffset = 0;
+	return allocate(size, alignment);
+}
+
+void Arena::deallocate(void* pointer, std::size_t size)
+{
+	// Only the most recent allocation can be given back, this lets a
+	// growing vector reuse the space it just left
+	if (currentBlock < blocks.size())
+	{
+		auto end = static_cast<std::byte*>(pointer) + size;
+		if (end == blocks[currentBlock].data.get() + currentOffset)
+		{
+			currentOffset -= size;
+		}
+	}
+}
+
+void Arena::reset()
+{
+	currentBlock = 0;
+	currentOffset = 0;
+	trim();
+}
+
+Arena::Marker Arena::mark() const
+{
+	return Marker{ currentBlock, currentOffset };
+}
+
+void Arena::rewind(const Marker& marker)
+{
+	currentBlock = marker.block;
+	currentOffset = marker.offset;
+	trim();
+}
+
+std::size_t Arena::reservedSize() const
+{
+	auto size = std::size_t{ 0 };
+	for (auto& block : blocks)
+	{
+		size += block.size;
+	}
+	return size;
+}
+
+void Arena::trim()
+{
+	// Blocks up to the current one are in use
+	auto retained = std::size_t{ 0 };
+	for (auto i = std::size_t{ 0 }; i <= currentBlock && i < blocks.size(); ++i)
+	{
+		retained += blocks[i].size;
+	}
+
+	auto kept = std::min(currentBlock + 1, blocks.size());
+	for (auto i = kept; i < blocks.size(); ++i)
+	{
+		if (blocks[i].size == _blockSize && retained + blocks[i].size <= _retainedSize)
+		{
+			retained += blocks[i].size;
+			if (kept != i)
+			{
+				blocks[kept] = std::move(blocks[i]);
+			}
+			++kept;
+		}
+	}
+	blocks.erase(blocks.begin() + kept, blocks.end());
+}
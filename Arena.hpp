@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for transient render data.
+// Memory is handed out linearly from large blocks and is only released by
+// rewinding. Up to retainedSize bytes of blocks are kept once they are free
+// again so that steady state rendering does not touch the heap, blocks past
+// that and blocks made for a single oversized allocation go back to the heap.
+class Arena
+{
+public:
+	explicit Arena(std::size_t blockSize = 1 << 20, std::size_t retainedSize = 8 << 20);
+
+	// A copy starts out empty, transient data is never shared between engines
+	Arena(const Arena& other);
+	Arena& operator=(const Arena& other);
+
+	Arena(Arena&& other) = default;
+	Arena& operator=(Arena&& other) = default;
+
+	void* allocate(std::size_t size, std::size_t alignment);
+
+	void deallocate(void* pointer, std::size_t size);
+
+	void reset();
+
+	struct Marker
+	{
+		std::size_t block;
+		std::size_t offset;
+	};
+
+	Marker mark() const;
+
+	void rewind(const Marker& marker);
+
+	// Bytes held in blocks, used or not
+	std::size_t reservedSize() const;
+
+	// Rewinds the arena to where it was on construction
+	class Scope
+	{
+	public:
+		explicit Scope(Arena& arena) : _arena(arena), _marker(arena.mark()) {}
+		~Scope() { _arena.rewind(_marker); }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		Arena& _arena;
+		Marker _marker;
+	};
+
+private:
+	struct Block
+	{
+		std::unique_ptr<std::byte[]> data;
+		std::size_t size;
+	};
+
+	// Frees the blocks past the current one that are over the retained size
+	void trim();
+
+	std::vector<Block> blocks;
+	std::size_t currentBlock = 0;
+	std::size_t currentOffset = 0;
+	std::size_t _blockSize;
+	std::size_t _retainedSize;
+};
+
+template <typename T>
+class ArenaAllocator
+{
+public:
+	using value_type = T;
+
+	ArenaAllocator(Arena& arena) : _arena(&arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other.arena()) {}
+
+	T* allocate(std::size_t n)
+	{
+		return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* pointer, std::size_t n)
+	{
+		_arena->deallocate(pointer, n * sizeof(T));
+	}
+
+	Arena* arena() const
+	{
+		return _arena;
+	}
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const
+	{
+		return _arena == other.arena();
+	}
+
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const
+	{
+		return _arena != other.arena();
+	}
+
+private:
+	Arena* _arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
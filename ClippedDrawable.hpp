@@ -0,0 +1,32 @@
+#pragma once
+#include "drawable.h"
+#include "primitives.hpp"
+
+// Drops writes outside a rect, so only part of the screen is drawn
+class ClippedDrawable : public Drawable
+{
+public:
+	ClippedDrawable(Drawable* surface, const Rect& clip) : surface(surface), clip(clip) {}
+
+	void setPixel(int x, int y, unsigned int color) override
+	{
+		if (x >= clip.x && x < clip.right() && y >= clip.y && y < clip.bottom())
+		{
+			surface->setPixel(x, y, color);
+		}
+	}
+
+	unsigned int getPixel(int x, int y) override
+	{
+		return surface->getPixel(x, y);
+	}
+
+	void updateScreen() override
+	{
+		surface->updateScreen();
+	}
+
+private:
+	Drawable* surface;
+	Rect clip;
+};
@@ -0,0 +1,297 @@
+#include "CommandStream.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+
+namespace
+{
+	// Index of T among the CommandParams alternatives
+	template <typename T, std::size_t I = 0>
+	constexpr std::uint8_t kindOf()
+	{
+		if constexpr (std::is_same_v<T, std::variant_alternative_t<I, CommandParams>>)
+		{
+			return I;
+		}
+		else
+		{
+			return kindOf<T, I + 1>();
+		}
+	}
+
+	bool sameColor(const FloatColor& a, const FloatColor& b)
+	{
+		return a.r == b.r && a.g == b.g && a.b == b.b;
+	}
+}
+
+CommandStream::CommandStream(const std::vector<Command>& commands)
+{
+	entries.reserve(commands.size());
+	for (auto& command : commands)
+	{
+		push_back(command);
+	}
+}
+
+void CommandStream::push_back(const Command& command)
+{
+	entries.push_back(pack(command));
+}
+
+void CommandStream::replace(std::size_t index, const Command& command)
+{
+	entries.at(index) = pack(command);
+}
+
+Command::Operation CommandStream::operation(std::size_t index) const
+{
+	return entries[index].operation;
+}
+
+CommandStream::Entry CommandStream::pack(const Command& command)
+{
+	auto entry = Entry{ command.operation(), static_cast<std::uint8_t>(command.parameters().index()), 0, 0 };
+
+	auto addNumbers = [this, &entry](std::initializer_list<double> values)
+	{
+		entry.offset = static_cast<std::uint32_t>(numbers.size());
+		entry.count = static_cast<std::uint32_t>(values.size());
+		numbers.insert(numbers.end(), values);
+	};
+
+	std::visit([&](const auto& params)
+	{
+		using T = std::decay_t<decltype(params)>;
+		if constexpr (std::is_same_v<T, PolygonParams> || std::is_same_v<T, LineParams>)
+		{
+			entry.offset = static_cast<std::uint32_t>(vertices.size());
+			entry.count = static_cast<std::uint32_t>(params.size());
+			for (auto& point : params)
+			{
+				addVertex(point);
+			}
+		}
+		else if constexpr (std::is_same_v<T, Point4D>)
+		{
+			entry.offset = addVertex(params);
+			entry.count = 1;
+		}
+		else if constexpr (std::is_same_v<T, Vector3>)
+		{
+			// Commands without params hold a zero Vector3, it takes no space
+			if (params != Vector3{})
+			{
+				addNumbers({ params[0], params[1], params[2] });
+			}
+		}
+		else if constexpr (std::is_same_v<T, LightParams> || std::is_same_v<T, SurfaceParams>)
+		{
+			entry.offset = static_cast<std::uint32_t>(numbers.size());
+			entry.count = static_cast<std::uint32_t>(params.size());
+			numbers.insert(numbers.end(), params.begin(), params.end());
+		}
+		else if constexpr (std::is_same_v<T, CameraParams>)
+		{
+			addNumbers({ params.xLow, params.yLow, params.xHigh, params.yHigh, params.near, params.far });
+		}
+		else if constexpr (std::is_same_v<T, DepthParams>)
+		{
+			auto [r, g, b] = params.color.getColorChannels();
+			addNumbers({ params.near, params.far, static_cast<double>(r), static_cast<double>(g), static_cast<double>(b) });
+		}
+		else if constexpr (std::is_same_v<T, Color>)
+		{
+			auto [r, g, b] = params.getColorChannels();
+			addNumbers({ static_cast<double>(r), static_cast<double>(g), static_cast<double>(b) });
+		}
+		else if constexpr (std::is_same_v<T, RotateParams>)
+		{
+			addNumbers({ static_cast<double>(static_cast<int>(params.first)), params.second });
+		}
+		else if constexpr (std::is_same_v<T, CreaseParams>)
+		{
+			addNumbers({ static_cast<double>(params) });
+		}
+		else if constexpr (std::is_same_v<T, MultisampleParams>)
+		{
+			addNumbers({ static_cast<double>(params.sampleCount) });
+		}
+		else if constexpr (std::is_same_v<T, LightingMethod>)
+		{
+			addNumbers({ static_cast<double>(static_cast<int>(params)) });
+		}
+		else if constexpr (std::is_same_v<T, KeyframeParams>)
+		{
+			entry.offset = static_cast<std::uint32_t>(numbers.size());
+			entry.count = static_cast<std::uint32_t>(params.values.size() + 1);
+			numbers.push_back(params.frame);
+			numbers.insert(numbers.end(), params.values.begin(), params.values.end());
+		}
+		else if constexpr (std::is_same_v<T, FaceParam>)
+		{
+			entry.offset = static_cast<std::uint32_t>(faceVertices.size());
+			entry.count = static_cast<std::uint32_t>(params.size());
+			faceVertices.insert(faceVertices.end(), params.begin(), params.end());
+		}
+		else if constexpr (std::is_same_v<T, FileParam>)
+		{
+			entry.offset = static_cast<std::uint32_t>(names.size());
+			entry.count = 1;
+			names.push_back(params);
+		}
+		else
+		{
+			static_assert(sizeof(T) == 0, "Every CommandParams alternative needs a packed form");
+		}
+	}, command.parameters());
+
+	return entry;
+}
+
+std::uint32_t CommandStream::addVertex(const Point4D& point)
+{
+	if (colors.empty() || !sameColor(colors.back(), point.color))
+	{
+		colors.push_back(point.color);
+	}
+
+	vertices.push_back(Vertex{ point.x, point.y, point.z, point.w, static_cast<std::uint32_t>(colors.size() - 1) });
+	return static_cast<std::uint32_t>(vertices.size() - 1);
+}
+
+Point4D CommandStream::vertexAt(std::size_t index) const
+{
+	auto& vertex = vertices[index];
+	return Point4D{ vertex.x, vertex.y, vertex.z, vertex.w, colors[vertex.color] };
+}
+
+template <typename T>
+T CommandStream::get(std::size_t index) const
+{
+	auto& entry = entries[index];
+	if (entry.kind != kindOf<T>())
+	{
+		throw std::invalid_argument("Command holds other params");
+	}
+
+	auto number = [this, &entry](std::size_t i) { return numbers[entry.offset + i]; };
+	auto color = [&number](std::size_t i)
+	{
+		return Color{ static_cast<unsigned char>(number(i)), static_cast<unsigned char>(number(i + 1)), static_cast<unsigned char>(number(i + 2)) };
+	};
+
+	if constexpr (std::is_same_v<T, Vector3>)
+	{
+		return entry.count == 0 ? Vector3{} : Vector3{ number(0), number(1), number(2) };
+	}
+	else if constexpr (std::is_same_v<T, PolygonParams>)
+	{
+		return PolygonParams{ vertexAt(entry.offset), vertexAt(entry.offset + 1), vertexAt(entry.offset + 2) };
+	}
+	else if constexpr (std::is_same_v<T, LineParams>)
+	{
+		return LineParams{ vertexAt(entry.offset), vertexAt(entry.offset + 1) };
+	}
+	else if constexpr (std::is_same_v<T, RotateParams>)
+	{
+		return RotateParams{ static_cast<Axis>(static_cast<int>(number(0))), number(1) };
+	}
+	else if constexpr (std::is_same_v<T, FileParam>)
+	{
+		return names[entry.offset];
+	}
+	else if constexpr (std::is_same_v<T, Color>)
+	{
+		return color(0);
+	}
+	else if constexpr (std::is_same_v<T, CameraParams>)
+	{
+		return CameraParams{ number(0), number(1), number(2), number(3), number(4), number(5) };
+	}
+	else if constexpr (std::is_same_v<T, DepthParams>)
+	{
+		return DepthParams{ number(0), number(1), color(2) };
+	}
+	else if constexpr (std::is_same_v<T, Point4D>)
+	{
+		return vertexAt(entry.offset);
+	}
+	else if constexpr (std::is_same_v<T, FaceParam>)
+	{
+		auto first = faceVertices.begin() + entry.offset;
+		return FaceParam(first, first + entry.count);
+	}
+	else if constexpr (std::is_same_v<T, LightParams>)
+	{
+		return LightParams{ number(0), number(1), number(2), number(3), number(4) };
+	}
+	else if constexpr (std::is_same_v<T, LightingMethod>)
+	{
+		return static_cast<LightingMethod>(static_cast<int>(number(0)));
+	}
+	else if constexpr (std::is_same_v<T, SurfaceParams>)
+	{
+		return SurfaceParams{ number(0), number(1) };
+	}
+	else if constexpr (std::is_same_v<T, CreaseParams>)
+	{
+		return static_cast<CreaseParams>(number(0));
+	}
+	else if constexpr (std::is_same_v<T, MultisampleParams>)
+	{
+		return MultisampleParams{ static_cast<int>(number(0)) };
+	}
+	else if constexpr (std::is_same_v<T, KeyframeParams>)
+	{
+		auto first = numbers.begin() + entry.offset;
+		return KeyframeParams{ *first, std::vector<double>(first + 1, first + entry.count) };
+	}
+	else
+	{
+		static_assert(sizeof(T) == 0, "Every CommandParams alternative needs a packed form");
+	}
+}
+
+template Vector3 CommandStream::get<Vector3>(std::size_t) const;
+template PolygonParams CommandStream::get<PolygonParams>(std::size_t) const;
+template LineParams CommandStream::get<LineParams>(std::size_t) const;
+template RotateParams CommandStream::get<RotateParams>(std::size_t) const;
+template FileParam CommandStream::get<FileParam>(std::size_t) const;
+template Color CommandStream::get<Color>(std::size_t) const;
+template CameraParams CommandStream::get<CameraParams>(std::size_t) const;
+template DepthParams CommandStream::get<DepthParams>(std::size_t) const;
+template Point4D CommandStream::get<Point4D>(std::size_t) const;
+template FaceParam CommandStream::get<FaceParam>(std::size_t) const;
+template LightParams CommandStream::get<LightParams>(std::size_t) const;
+template LightingMethod CommandStream::get<LightingMethod>(std::size_t) const;
+template SurfaceParams CommandStream::get<SurfaceParams>(std::size_t) const;
+template CreaseParams CommandStream::get<CreaseParams>(std::size_t) const;
+template MultisampleParams CommandStream::get<MultisampleParams>(std::size_t) const;
+template KeyframeParams CommandStream::get<KeyframeParams>(std::size_t) const;
+
+namespace
+{
+	// Rebuilds the command from the params alternative at I
+	template <std::size_t I = 0>
+	Command rebuild(const CommandStream& stream, std::size_t index, std::uint8_t kind)
+	{
+		if constexpr (I < std::variant_size_v<CommandParams>)
+		{
+			if (kind == I)
+			{
+				return Command{ stream.operation(index), stream.get<std::variant_alternative_t<I, CommandParams>>(index) };
+			}
+			return rebuild<I + 1>(stream, index, kind);
+		}
+		else
+		{
+			throw std::invalid_argument("Unknown command payload");
+		}
+	}
+}
+
+Command CommandStream::operator[](std::size_t index) const
+{
+	return rebuild(*this, index, entries[index].kind);
+}
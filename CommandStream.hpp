@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "command.hpp"
+#include "FloatColor.hpp"
+
+// Commands packed for large scenes. Each one is an opcode with an offset into
+// typed side arrays, so a brace or a mode switch costs one entry and a polygon
+// three small vertices instead of a whole Command. Commands are rebuilt when
+// they are read, a View reads the opcode and params in place instead.
+// Vertices keep what a parse gives them, a position and a color.
+class CommandStream
+{
+public:
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = Command;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = Command;
+
+		const_iterator(const CommandStream* stream, std::size_t index) : stream(stream), index(index) {}
+
+		Command operator*() const { return (*stream)[index]; }
+		const_iterator& operator++() { ++index; return *this; }
+		const_iterator operator++(int) { auto old = *this; ++index; return old; }
+		bool operator==(const const_iterator& other) const { return index == other.index; }
+		bool operator!=(const const_iterator& other) const { return index != other.index; }
+
+	private:
+		const CommandStream* stream;
+		std::size_t index;
+	};
+
+	// One command of a stream, read without rebuilding it. Has the same
+	// operation() and get<T>() as a Command
+	class View
+	{
+	public:
+		View(const CommandStream& stream, std::size_t index) : stream(&stream), index(index) {}
+
+		Command::Operation operation() const { return stream->operation(index); }
+
+		template <typename T>
+		T get() const { return stream->get<T>(index); }
+
+	private:
+		const CommandStream* stream;
+		std::size_t index;
+	};
+
+	CommandStream() = default;
+
+	// Packs commands built one by one
+	CommandStream(const std::vector<Command>& commands);
+
+	void push_back(const Command& command);
+
+	// The old payload stays behind, a stream is not meant to be edited often
+	void replace(std::size_t index, const Command& command);
+
+	Command operator[](std::size_t index) const;
+
+	// Reads the opcode alone, without rebuilding the command
+	Command::Operation operation(std::size_t index) const;
+
+	// Decodes the params alone, T has to be the CommandParams alternative the command holds
+	template <typename T>
+	T get(std::size_t index) const;
+
+	View view(std::size_t index) const { return View(*this, index); }
+
+	std::size_t size() const { return entries.size(); }
+	bool empty() const { return entries.empty(); }
+
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, entries.size()); }
+
+private:
+	struct Entry
+	{
+		Command::Operation operation;
+		// Which CommandParams alternative the payload is
+		std::uint8_t kind;
+		std::uint32_t offset;
+		std::uint32_t count;
+	};
+
+	struct Vertex
+	{
+		double x;
+		double y;
+		double z;
+		double w;
+		std::uint32_t color;
+	};
+
+	Entry pack(const Command& command);
+	std::uint32_t addVertex(const Point4D& point);
+	Point4D vertexAt(std::size_t index) const;
+
+	std::vector<Entry> entries;
+	// Polygon, line and single point params
+	std::vector<Vertex> vertices;
+	// Vertex colors, a run of vertices with the same color shares one
+	std::vector<FloatColor> colors;
+	// Every other numeric param, flattened
+	std::vector<double> numbers;
+	std::vector<VertexParam> faceVertices;
+	std::vector<std::string> names;
+};
@@ -1,9 +1,36 @@
 #pragma once
 #include "Color.hpp"
+#include "FloatColor.hpp"
 
 struct Depth
 {
 	double near;
 	double far;
 	Color color;
-};
\ No newline at end of file
+};
+
+// Depth cueing with its range inverted up front, applied to a fragment
+// while it is written
+struct DepthCue
+{
+	explicit DepthCue(const Depth& depth) : near(depth.near), far(depth.far), inverseRange(1.0 / (depth.far - depth.near)), color(depth.color) {}
+
+	FloatColor apply(const FloatColor& fragmentColor, double z) const
+	{
+		if (z > far)
+		{
+			return color;
+		}
+		else if (z > near)
+		{
+			auto factor = (z - near) * inverseRange;
+			return fragmentColor * (1 - factor) + color * factor;
+		}
+		return fragmentColor;
+	}
+
+	double near;
+	double far;
+	double inverseRange;
+	FloatColor color;
+};
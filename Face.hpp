@@ -2,14 +2,18 @@
 #include "CommonTypeAliases.hpp"
 #include "primitives.hpp"
 #include "Vertex.hpp"
+#include <array>
 #include <vector>
 
 struct Face
 {
-	// Cannot default construct
-	// consider using pointers
-	std::vector<Vertex*> vertices;
+	// Indices into the vertex and normal lists of the owning mesh
+	std::array<int, 3> vertexIndices;
+	std::array<int, 3> normalIndices;
+	// Edge i runs from corner i to corner i + 1, indices into the mesh edge list
+	std::array<int, 3> edgeIndices;
+	// Every corner uses a normal given by the obj file rather than a smoothed one
+	bool hasAssignedNormals = false;
 	Point4D normal;
-	std::vector<int> vertexIndices;
-	Point4D getFaceNormal() const;
-};
\ No newline at end of file
+	Point4D getFaceNormal(const std::vector<Vertex>& vertices) const;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+
+#include "Color.hpp"
+
+// Working color of the shading pipeline. Channels are normalized floats that
+// may run past 1 while light accumulates; they are only clamped and
+// quantized once, when the pixel is written.
+struct FloatColor
+{
+	FloatColor() : r(0.0f), g(0.0f), b(0.0f) {}
+	FloatColor(float red, float green, float blue) : r(red), g(green), b(blue) {}
+	FloatColor(const Color& color)
+	{
+		auto channels = color.getColorChannels();
+		r = std::get<0>(channels) / 255.0f;
+		g = std::get<1>(channels) / 255.0f;
+		b = std::get<2>(channels) / 255.0f;
+	}
+
+	Color toColor() const
+	{
+		return Color{ quantize(r), quantize(g), quantize(b) };
+	}
+
+	unsigned int asUnsigned() const
+	{
+		return 0xff000000 | (quantize(r) << 16) | (quantize(g) << 8) | quantize(b);
+	}
+
+	float r;
+	float g;
+	float b;
+
+private:
+	static unsigned char quantize(float channel)
+	{
+		return static_cast<unsigned char>(std::min(std::max(channel, 0.0f), 1.0f) * 255.0f);
+	}
+};
+
+inline
+FloatColor operator*(const FloatColor& l, const FloatColor& r)
+{
+	return FloatColor{ l.r * r.r, l.g * r.g, l.b * r.b };
+}
+
+inline
+FloatColor operator*(const FloatColor& c, double s)
+{
+	auto scale = static_cast<float>(s);
+	return FloatColor{ c.r * scale, c.g * scale, c.b * scale };
+}
+
+inline
+FloatColor operator+(const FloatColor& l, const FloatColor& r)
+{
+	return FloatColor{ l.r + r.r, l.g + r.g, l.b + r.b };
+}
@@ -0,0 +1,233 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+JobSystem::JobSystem(int workerCount)
+{
+	if (workerCount <= 0)
+	{
+		workerCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	}
+
+	for (auto i = 0; i < workerCount; ++i)
+	{
+		threads.emplace_back(&JobSystem::work, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+JobSystem& JobSystem::shared()
+{
+	static JobSystem jobSystem;
+	return jobSystem;
+}
+
+void JobSystem::setTimingHook(TimingHook_t hook)
+{
+	auto shared = hook ? std::make_shared<const TimingHook_t>(std::move(hook)) : nullptr;
+	std::lock_guard<std::mutex> lock(mutex);
+	timingHook = std::move(shared);
+}
+
+void JobSystem::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body, const std::string& name, std::size_t grainSize)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// A few chunks per worker balance uneven work without a job per index
+	grainSize = std::max(grainSize, std::size_t{ 1 });
+	auto chunkCount = std::min((count + grainSize - 1) / grainSize, static_cast<std::size_t>(workerCount()) * 4);
+	if (chunkCount == 1)
+	{
+		for (auto i = std::size_t{ 0 }; i < count; ++i)
+		{
+			body(i);
+		}
+		return;
+	}
+
+	TaskGraph graph;
+	for (auto chunk = std::size_t{ 0 }; chunk < chunkCount; ++chunk)
+	{
+		auto begin = count * chunk / chunkCount;
+		auto end = count * (chunk + 1) / chunkCount;
+		graph.add(name, [&body, begin, end]()
+		{
+			for (auto i = begin; i < end; ++i)
+			{
+				body(i);
+			}
+		});
+	}
+	graph.run(*this);
+}
+
+void JobSystem::enqueue(const Task& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(task);
+	}
+	wake.notify_one();
+}
+
+void JobSystem::help(const TaskGraph& graph)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!graph.finished())
+	{
+		wake.wait(lock, [this, &graph]() { return !queue.empty() || graph.finished(); });
+		if (queue.empty())
+		{
+			continue;
+		}
+
+		auto task = queue.front();
+		queue.pop_front();
+		lock.unlock();
+		execute(task, -1);
+		lock.lock();
+	}
+}
+
+void JobSystem::execute(const Task& task, int worker)
+{
+	auto& graph = *task.graph;
+	auto& job = graph.jobs[task.job];
+
+	auto start = std::chrono::steady_clock::now();
+	bool failed;
+	{
+		std::lock_guard<std::mutex> lock(graph.errorMutex);
+		failed = graph.error != nullptr;
+	}
+	if (!failed)
+	{
+		try
+		{
+			job.work();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(graph.errorMutex);
+			if (!graph.error)
+			{
+				graph.error = std::current_exception();
+			}
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	std::shared_ptr<const TimingHook_t> hook;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		hook = timingHook;
+	}
+	if (hook)
+	{
+		(*hook)(JobTiming{ job.name, start, end, worker });
+	}
+
+	for (auto dependent : job.dependents)
+	{
+		if (--graph.jobs[dependent].remaining == 0)
+		{
+			enqueue(Task{ &graph, dependent });
+		}
+	}
+
+	// Waiting threads check finished() under the lock, so take it before waking them
+	if (++graph.finishedJobs == graph.jobs.size())
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		wake.notify_all();
+	}
+}
+
+void JobSystem::work(int worker)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		wake.wait(lock, [this]() { return !queue.empty() || stopping; });
+		if (queue.empty())
+		{
+			return;
+		}
+
+		auto task = queue.front();
+		queue.pop_front();
+		lock.unlock();
+		execute(task, worker);
+		lock.lock();
+	}
+}
+
+TaskGraph::JobId_t TaskGraph::add(const std::string& name, std::function<void()> work, const std::vector<JobId_t>& dependencies)
+{
+	auto id = jobs.size();
+	for (auto dependency : dependencies)
+	{
+		if (dependency >= id)
+		{
+			throw std::invalid_argument("A job can only depend on jobs added before it");
+		}
+		jobs[dependency].dependents.push_back(id);
+	}
+
+	auto& job = jobs.emplace_back();
+	job.name = name;
+	job.work = std::move(work);
+	job.dependencyCount = static_cast<int>(dependencies.size());
+	return id;
+}
+
+void TaskGraph::run(JobSystem& jobSystem)
+{
+	start(jobSystem);
+	wait(jobSystem);
+}
+
+void TaskGraph::start(JobSystem& jobSystem)
+{
+	finishedJobs = 0;
+	error = nullptr;
+	for (auto& job : jobs)
+	{
+		job.remaining = job.dependencyCount;
+	}
+
+	for (auto i = std::size_t{ 0 }; i < jobs.size(); ++i)
+	{
+		if (jobs[i].dependencyCount == 0)
+		{
+			jobSystem.enqueue(JobSystem::Task{ this, i });
+		}
+	}
+}
+
+void TaskGraph::wait(JobSystem& jobSystem)
+{
+	jobSystem.help(*this);
+
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+}
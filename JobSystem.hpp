@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct JobTiming
+{
+	std::string name;
+	std::chrono::steady_clock::time_point start;
+	// Includes any jobs run while the job waited on a graph of its own
+	std::chrono::steady_clock::time_point end;
+	// Pool thread that ran the job, -1 for a thread waiting on its graph
+	int worker;
+};
+
+class TaskGraph;
+
+// Fixed pool of worker threads that runs the jobs of task graphs. Threads
+// waiting on a graph run queued jobs too, so graphs can be run from inside
+// a job without tying up the pool.
+class JobSystem
+{
+public:
+	// 0 workers means one per core
+	explicit JobSystem(int workerCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Process wide pool, one worker per core
+	static JobSystem& shared();
+
+	int workerCount() const
+	{
+		return static_cast<int>(threads.size());
+	}
+
+	using TimingHook_t = std::function<void(const JobTiming&)>;
+
+	// Called after every job, from the thread that ran it
+	void setTimingHook(TimingHook_t hook);
+
+	// Runs body(i) for every i below count, split into a few jobs per worker
+	// of at least grainSize indices each
+	void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body, const std::string& name = "parallel for", std::size_t grainSize = 1);
+
+private:
+	friend class TaskGraph;
+
+	struct Task
+	{
+		TaskGraph* graph;
+		std::size_t job;
+	};
+
+	void enqueue(const Task& task);
+
+	// Runs queued jobs until graph is finished
+	void help(const TaskGraph& graph);
+
+	void execute(const Task& task, int worker);
+
+	void work(int worker);
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<Task> queue;
+	bool stopping = false;
+	std::vector<std::thread> threads;
+	std::shared_ptr<const TimingHook_t> timingHook;
+};
+
+// Jobs and the jobs they wait for. A graph is built up front and can be run
+// any number of times, each job runs once per run after all of its
+// dependencies have finished.
+class TaskGraph
+{
+public:
+	using JobId_t = std::size_t;
+
+	JobId_t add(const std::string& name, std::function<void()> work, const std::vector<JobId_t>& dependencies = {});
+
+	// Blocks until every job has run, the calling thread runs jobs as well.
+	// Jobs left once one has thrown are skipped and the exception is rethrown
+	void run(JobSystem& jobSystem);
+
+	// Queues the jobs without waiting for them
+	void start(JobSystem& jobSystem);
+
+	// Finishes a started graph, the same as the second half of run
+	void wait(JobSystem& jobSystem);
+
+private:
+	friend class JobSystem;
+
+	struct Job
+	{
+		std::string name;
+		std::function<void()> work;
+		std::vector<JobId_t> dependents;
+		int dependencyCount = 0;
+		std::atomic<int> remaining{ 0 };
+	};
+
+	bool finished() const
+	{
+		return finishedJobs.load() == jobs.size();
+	}
+
+	// Deque so the atomics never move
+	std::deque<Job> jobs;
+	std::atomic<std::size_t> finishedJobs{ 0 };
+	std::exception_ptr error;
+	std::mutex errorMutex;
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "primitives.hpp"
+
+// Lines in camera space, drawn together. An endpoint several of them share
+// is stored once and indexed.
+struct LineBatch
+{
+	std::vector<Point4D> vertices;
+	std::vector<std::array<std::uint32_t, 2>> lines;
+};
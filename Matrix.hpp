@@ -1,6 +1,7 @@
 #pragma once
 #include <array>
 #include <algorithm>
+#include <stdexcept>
 #include "primitives.hpp"
 
 template <int width, int height, typename T>
@@ -11,8 +12,8 @@ class Matrix
 
 public:
 
-	template <typename... T>
-	Matrix(T... values)
+	template <typename... Ts>
+	Matrix(Ts... values)
 	{
 		_data = { values... };
 	}
@@ -69,15 +70,15 @@ private:
 template <typename T>
 auto operator*(Matrix<4, 4, T>& l, Matrix<4, 4, T>& r)
 {
-	auto row0 = l.getRow<0>();
-	auto row1 = l.getRow<1>();
-	auto row2 = l.getRow<2>();
-	auto row3 = l.getRow<3>();
+	auto row0 = l.template getRow<0>();
+	auto row1 = l.template getRow<1>();
+	auto row2 = l.template getRow<2>();
+	auto row3 = l.template getRow<3>();
 
-	auto otherCol0 = r.getCol<0>();
-	auto otherCol1 = r.getCol<1>();
-	auto otherCol2 = r.getCol<2>();
-	auto otherCol3 = r.getCol<3>();
+	auto otherCol0 = r.template getCol<0>();
+	auto otherCol1 = r.template getCol<1>();
+	auto otherCol2 = r.template getCol<2>();
+	auto otherCol3 = r.template getCol<3>();
 
 	auto elem00 = row0[0] * otherCol0[0] + row0[1] * otherCol0[1] + row0[2] * otherCol0[2] + row0[3] * otherCol0[3];
 	auto elem01 = row0[0] * otherCol1[0] + row0[1] * otherCol1[1] + row0[2] * otherCol1[2] + row0[3] * otherCol1[3];
@@ -109,10 +110,10 @@ auto operator*(Matrix<4, 4, T>& l, Matrix<4, 4, T>& r)
 template <typename T>
 auto operator*(const Matrix<4, 4, T>& matrix, const std::array<T, 4>& vector)
 {
-	return std::array<T, 4> { matrix.getElement<0, 0>() * vector[0] + matrix.getElement<0, 1>() * vector[1] + matrix.getElement<0, 2>() * vector[2] + matrix.getElement<0, 3>() * vector[3],
-							  matrix.getElement<1, 0>() * vector[0] + matrix.getElement<1, 1>() * vector[1] + matrix.getElement<1, 2>() * vector[2] + matrix.getElement<1, 3>() * vector[3],
-							  matrix.getElement<2, 0>() * vector[0] + matrix.getElement<2, 1>() * vector[1] + matrix.getElement<2, 2>() * vector[2] + matrix.getElement<2, 3>() * vector[3],
-							  matrix.getElement<3, 0>() * vector[0] + matrix.getElement<3, 1>() * vector[1] + matrix.getElement<3, 2>() * vector[2] + matrix.getElement<3, 3>() * vector[3] };
+	return std::array<T, 4> { matrix.template getElement<0, 0>() * vector[0] + matrix.template getElement<0, 1>() * vector[1] + matrix.template getElement<0, 2>() * vector[2] + matrix.template getElement<0, 3>() * vector[3],
+							  matrix.template getElement<1, 0>() * vector[0] + matrix.template getElement<1, 1>() * vector[1] + matrix.template getElement<1, 2>() * vector[2] + matrix.template getElement<1, 3>() * vector[3],
+							  matrix.template getElement<2, 0>() * vector[0] + matrix.template getElement<2, 1>() * vector[1] + matrix.template getElement<2, 2>() * vector[2] + matrix.template getElement<2, 3>() * vector[3],
+							  matrix.template getElement<3, 0>() * vector[0] + matrix.template getElement<3, 1>() * vector[1] + matrix.template getElement<3, 2>() * vector[2] + matrix.template getElement<3, 3>() * vector[3] };
 }
 
 template <typename T>
@@ -263,4 +264,14 @@ auto invert(const Matrix<4, 4, T>& matrix)
 	std::transform(inv.begin(), inv.end(), result.begin(), [det](auto e) { return e * det; });
 
 	return Matrix<4, 4, T>{result};
-}
\ No newline at end of file
+}
+template <typename T>
+auto transpose(const Matrix<4, 4, T>& matrix)
+{
+	auto m = matrix.getData();
+
+	return Matrix<4, 4, T>{ m[0], m[4], m[8],  m[12],
+							m[1], m[5], m[9],  m[13],
+							m[2], m[6], m[10], m[14],
+							m[3], m[7], m[11], m[15] };
+}
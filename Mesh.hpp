@@ -0,0 +1,19 @@
+#pragma once
+#include <array>
+#include <string>
+#include <vector>
+
+#include "Face.hpp"
+#include "Vertex.hpp"
+
+// Geometry loaded from an obj file, kept in object space so that it can be
+// drawn any number of times under different model transforms.
+struct Mesh
+{
+	std::string name;
+	std::vector<Vertex> vertices;
+	std::vector<Point> normals;
+	std::vector<Face> faces;
+	// Every edge once, even when faces share it
+	std::vector<std::array<int, 2>> edges;
+};
@@ -0,0 +1,193 @@
+#include "MeshBuilder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+MeshBuilder::MeshBuilder(const std::string& name, int creaseAngle) : _creaseAngle(creaseAngle)
+{
+	_mesh.name = name;
+}
+
+void MeshBuilder::addVertex(const Point4D& location)
+{
+	_mesh.vertices.push_back(Vertex{ location });
+	assignedNormals.push_back(-1);
+}
+
+void MeshBuilder::addNormal(const Point& normal)
+{
+	_mesh.normals.push_back(normal);
+}
+
+// obj indices are 1-based, negative values count back from the last element
+std::size_t MeshBuilder::resolveIndex(int objIndex, std::size_t count, const char* element) const
+{
+	auto index = objIndex > 0 ? static_cast<long long>(objIndex) - 1 : static_cast<long long>(count) + objIndex;
+	if (objIndex == 0 || index < 0 || index >= static_cast<long long>(count))
+	{
+		throw std::out_of_range("Face in " + _mesh.name + " refers to " + element + " " + std::to_string(objIndex) +
+								" but only " + std::to_string(count) + " are defined");
+	}
+	return static_cast<std::size_t>(index);
+}
+
+void MeshBuilder::addFace(const FaceParam& face)
+{
+	if (face.size() < 3)
+	{
+		throw std::invalid_argument("Face needs at least three vertices");
+	}
+
+	auto polygon = static_cast<int>(polygonNormals.size());
+	auto firstVertex = polygonVertexIndices.size();
+	for (auto& vertex : face)
+	{
+		auto index = resolveIndex(vertex[0], _mesh.vertices.size(), "vertex");
+		polygonVertexIndices.push_back(static_cast<int>(index));
+
+		// Normal
+		if (vertex[2] != 0)
+		{
+			auto normalIndex = resolveIndex(vertex[2], _mesh.normals.size(), "normal");
+			assignedNormals[index] = static_cast<int>(normalIndex);
+		}
+	}
+	polygonOffsets.push_back(polygonVertexIndices.size());
+
+	// Triangulate as a fan, every triangle shares the normal of the polygon
+	auto firstFace = _mesh.faces.size();
+	for (auto i = firstVertex + 1; i < polygonVertexIndices.size() - 1; ++i)
+	{
+		Face f;
+		f.vertexIndices = { polygonVertexIndices[firstVertex], polygonVertexIndices[i], polygonVertexIndices[i + 1] };
+		_mesh.faces.push_back(f);
+		facePolygons.push_back(polygon);
+	}
+
+	auto normal = _mesh.faces[firstFace].getFaceNormal(_mesh.vertices);
+	for (auto f = firstFace; f < _mesh.faces.size(); ++f)
+	{
+		_mesh.faces[f].normal = normal;
+	}
+	polygonNormals.push_back(normal);
+}
+
+void MeshBuilder::resolveNormals()
+{
+	auto vertexCount = _mesh.vertices.size();
+
+	// Polygons around every vertex, in the order they were added
+	std::vector<std::size_t> incidentOffsets(vertexCount + 1, 0);
+	for (auto v : polygonVertexIndices)
+	{
+		++incidentOffsets[v + 1];
+	}
+	std::partial_sum(incidentOffsets.begin(), incidentOffsets.end(), incidentOffsets.begin());
+
+	std::vector<int> incidentPolygons(polygonVertexIndices.size());
+	auto nextIncident = incidentOffsets;
+	for (auto polygon = 0u; polygon < polygonNormals.size(); ++polygon)
+	{
+		for (auto i = polygonOffsets[polygon]; i < polygonOffsets[polygon + 1]; ++i)
+		{
+			incidentPolygons[nextIncident[polygonVertexIndices[i]]++] = polygon;
+		}
+	}
+
+	// Smoothed normals are appended after the ones read from the file. Corners
+	// of one vertex that end up with the same normal share a single entry,
+	// chained through nextNormal
+	auto smoothAll = _creaseAngle >= 180;
+	auto cosCreaseAngle = std::cos(getRadianFromDegree(_creaseAngle));
+	std::vector<int> firstNormal(vertexCount, -1);
+	std::vector<int> nextNormal(_mesh.normals.size(), -1);
+
+	for (auto f = 0u; f < _mesh.faces.size(); ++f)
+	{
+		auto& face = _mesh.faces[f];
+		face.hasAssignedNormals = std::all_of(face.vertexIndices.begin(), face.vertexIndices.end(), [this](auto v) { return assignedNormals[v] >= 0; });
+
+		for (auto corner = 0u; corner < face.vertexIndices.size(); ++corner)
+		{
+			auto v = face.vertexIndices[corner];
+			if (face.hasAssignedNormals)
+			{
+				face.normalIndices[corner] = assignedNormals[v];
+				continue;
+			}
+
+			if (smoothAll && firstNormal[v] >= 0)
+			{
+				face.normalIndices[corner] = firstNormal[v];
+				continue;
+			}
+
+			auto polygon = facePolygons[f];
+			auto sum = Point4D{ 0.0, 0.0, 0.0, 1.0 };
+			for (auto i = incidentOffsets[v]; i < incidentOffsets[v + 1]; ++i)
+			{
+				auto other = incidentPolygons[i];
+				if (smoothAll || other == polygon || dot(polygonNormals[polygon], polygonNormals[other]) >= cosCreaseAngle)
+				{
+					sum = sum + polygonNormals[other];
+				}
+			}
+			auto normal4D = normalize(sum);
+			auto normal = Point{ normal4D.x, normal4D.y, normal4D.z };
+
+			auto index = firstNormal[v];
+			while (index >= 0 && !(_mesh.normals[index].x == normal.x && _mesh.normals[index].y == normal.y && _mesh.normals[index].z == normal.z))
+			{
+				index = nextNormal[index];
+			}
+
+			if (index < 0)
+			{
+				index = static_cast<int>(_mesh.normals.size());
+				_mesh.normals.push_back(normal);
+				nextNormal.push_back(firstNormal[v]);
+				firstNormal[v] = index;
+			}
+
+			face.normalIndices[corner] = index;
+		}
+	}
+}
+
+void MeshBuilder::buildEdges()
+{
+	std::unordered_map<std::uint64_t, int> edgeLookup;
+	edgeLookup.reserve(_mesh.faces.size() * 3 / 2);
+
+	for (auto& face : _mesh.faces)
+	{
+		for (auto corner = 0u; corner < face.vertexIndices.size(); ++corner)
+		{
+			auto a = face.vertexIndices[corner];
+			auto b = face.vertexIndices[(corner + 1) % face.vertexIndices.size()];
+			if (a > b)
+			{
+				std::swap(a, b);
+			}
+
+			auto key = (static_cast<std::uint64_t>(a) << 32) | static_cast<std::uint32_t>(b);
+			auto edge = edgeLookup.emplace(key, static_cast<int>(_mesh.edges.size()));
+			if (edge.second)
+			{
+				_mesh.edges.push_back({ a, b });
+			}
+			face.edgeIndices[corner] = edge.first->second;
+		}
+	}
+}
+
+Mesh MeshBuilder::build()
+{
+	resolveNormals();
+	buildEdges();
+	return std::move(_mesh);
+}
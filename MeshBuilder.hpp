@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "command.hpp"
+#include "Mesh.hpp"
+
+// Accumulates the v/vn/f commands of one obj file into a Mesh.
+// Each nested obj include gets its own builder, so the data of the
+// enclosing file is never copied.
+class MeshBuilder
+{
+public:
+	// Polygons meeting at an angle wider than creaseAngle (in degrees) do
+	// not smooth into each other, 180 smooths across every edge
+	explicit MeshBuilder(const std::string& name, int creaseAngle = 180);
+
+	void addVertex(const Point4D& location);
+
+	void addNormal(const Point& normal);
+
+	void addFace(const FaceParam& face);
+
+	// Resolves the vertex normals and moves the accumulated geometry out,
+	// the builder is empty afterwards
+	Mesh build();
+
+private:
+	// Throws std::out_of_range naming the element when the index has nothing to refer to
+	std::size_t resolveIndex(int objIndex, std::size_t count, const char* element) const;
+
+	void resolveNormals();
+
+	void buildEdges();
+
+	Mesh _mesh;
+	int _creaseAngle;
+
+	// Normal given by the obj file for each vertex, -1 if none
+	std::vector<int> assignedNormals;
+
+	// Polygons as they appeared in the file, before triangulation
+	std::vector<Point4D> polygonNormals;
+	std::vector<int> polygonVertexIndices;
+	std::vector<std::size_t> polygonOffsets = { 0 };
+	std::vector<int> facePolygons;
+};
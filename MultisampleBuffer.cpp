@@ -0,0 +1,50 @@
+#include "MultisampleBuffer.hpp"
+
+#include <stdexcept>
+
+MultisampleBuffer::MultisampleBuffer(int width, int height, int sampleCount) : height(height), _offsets(samplePattern(sampleCount))
+{
+	auto pixels = static_cast<std::size_t>(width) * height;
+	touched.assign(pixels, false);
+	depths.resize(pixels * _offsets.size());
+	colors.resize(pixels * _offsets.size());
+}
+
+const SampleOffsets_t& MultisampleBuffer::samplePattern(int sampleCount)
+{
+	// Rotated grid patterns, in sixteenths of a pixel
+	static const SampleOffsets_t fourSamples{ { -2 / 16.0, -6 / 16.0 }, { 6 / 16.0, -2 / 16.0 }, { -6 / 16.0, 2 / 16.0 }, { 2 / 16.0, 6 / 16.0 } };
+	static const SampleOffsets_t eightSamples{ { 1 / 16.0, -3 / 16.0 }, { -1 / 16.0, 3 / 16.0 }, { 5 / 16.0, 1 / 16.0 }, { -3 / 16.0, -5 / 16.0 },
+											   { -5 / 16.0, 5 / 16.0 }, { -7 / 16.0, -1 / 16.0 }, { 3 / 16.0, 7 / 16.0 }, { 7 / 16.0, -7 / 16.0 } };
+
+	switch (sampleCount)
+	{
+		case 4:
+		{
+			return fourSamples;
+		} break;
+
+		case 8:
+		{
+			return eightSamples;
+		} break;
+
+		default:
+		{
+			throw std::invalid_argument("Unsupported sample count");
+		}
+	}
+}
+
+FloatColor MultisampleBuffer::resolve(int x, int y, double& farthestZ) const
+{
+	auto first = index(x, y) * _offsets.size();
+	auto sum = FloatColor{};
+	farthestZ = depths[first];
+	for (auto i = first; i < first + _offsets.size(); ++i)
+	{
+		sum = sum + colors[i];
+		farthestZ = std::max(farthestZ, depths[i]);
+	}
+	return sum * (1.0 / _offsets.size());
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "FloatColor.hpp"
+
+using SampleOffsets_t = std::vector<std::array<double, 2>>;
+
+// Which samples of a pixel a fragment covers, with the screen space slope of
+// 1/z so each sample gets its own depth. Kept next to the fragments rather
+// than in them, only multisampled polygons have any
+struct SampleCoverage
+{
+	unsigned mask;
+	double oneOverZdx;
+	double oneOverZdy;
+};
+
+// Per-sample depth and color for multisampled triangles. Shading still happens
+// once per pixel, only coverage and the depth test are per sample. A pixel is
+// resolved back to the surface as soon as one of its samples changes.
+class MultisampleBuffer
+{
+public:
+	MultisampleBuffer(int width, int height, int sampleCount);
+
+	// Sample positions relative to the pixel center, only 4 and 8 are supported
+	static const SampleOffsets_t& samplePattern(int sampleCount);
+
+	const SampleOffsets_t& offsets() const
+	{
+		return _offsets;
+	}
+
+	int sampleCount() const
+	{
+		return static_cast<int>(_offsets.size());
+	}
+
+	// Seeds the samples of an untouched pixel with what is already drawn
+	// there, so earlier lines and points take part in the resolve
+	void touch(int x, int y, const FloatColor& surfaceColor, double surfaceZ)
+	{
+		auto pixel = index(x, y);
+		if (touched[pixel])
+		{
+			return;
+		}
+		touched[pixel] = true;
+		auto first = pixel * _offsets.size();
+		std::fill(depths.begin() + first, depths.begin() + first + _offsets.size(), surfaceZ);
+		std::fill(colors.begin() + first, colors.begin() + first + _offsets.size(), surfaceColor);
+	}
+
+	// The next touch seeds the pixel again
+	void clear(int x, int y)
+	{
+		touched[index(x, y)] = false;
+	}
+
+	double& depth(int x, int y, int sample)
+	{
+		return depths[index(x, y) * _offsets.size() + sample];
+	}
+
+	FloatColor& color(int x, int y, int sample)
+	{
+		return colors[index(x, y) * _offsets.size() + sample];
+	}
+
+	// Averages the samples of a pixel, also returns the farthest sample depth
+	// so the pixel depth buffer only hides what is behind every sample
+	FloatColor resolve(int x, int y, double& farthestZ) const;
+
+private:
+	std::size_t index(int x, int y) const
+	{
+		return static_cast<std::size_t>(x) * height + y;
+	}
+
+	int height;
+	SampleOffsets_t _offsets;
+	std::vector<bool> touched;
+	std::vector<double> depths;
+	std::vector<FloatColor> colors;
+};
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 #include <numeric>
 
 #include "lerp.hpp"
@@ -168,69 +169,53 @@ namespace PointGenerator
 		}
 	}
 
-	// Color helpers
-	std::tuple<Lerp<double>, Lerp<double>, Lerp<double>> getColorLerp(const Point4D& point1, const Point4D& point2)
+	// Steps [first, last) of a first octant line from point1 to point2 that can
+	// land in bounds, one either side to spare. Counted in doubles, so lines
+	// longer than an int can hold only cost the part that is on screen
+	std::pair<double, double> visibleLineSteps(Octant octant, const Point4D& point1, const Point4D& point2, const Rect& bounds)
 	{
-		auto p1ColorChannels = point1.color.getColorChannels();
-		auto p1Red = std::get<0>(p1ColorChannels);
-		auto p1Green = std::get<1>(p1ColorChannels);
-		auto p1Blue = std::get<2>(p1ColorChannels);
-
-		auto p2ColorChannels = point2.color.getColorChannels();
-		auto p2Red = std::get<0>(p2ColorChannels);
-		auto p2Green = std::get<1>(p2ColorChannels);
-		auto p2Blue = std::get<2>(p2ColorChannels);
-
-
-		Lerp<double> redLerp(point1.x, point2.x, p1Red, p2Red);
-		Lerp<double> greenLerp(point1.x, point2.x, p1Green, p2Green);
-		Lerp<double> blueLerp(point1.x, point2.x, p1Blue, p2Blue);
-
-
-		return std::make_tuple(redLerp, greenLerp, blueLerp);
-	}
-
-	Color getColorFromLerp(int colorIndex, const std::tuple<Lerp<double>, Lerp<double>, Lerp<double>>& colorLerps)
-	{
-		auto redLerp = std::get<0>(colorLerps);
-		auto greenLerp = std::get<1>(colorLerps);
-		auto blueLerp = std::get<2>(colorLerps);
-
-		auto r = static_cast<unsigned char>(redLerp[colorIndex].second);
-		auto g = static_cast<unsigned char>(greenLerp[colorIndex].second);
-		auto b = static_cast<unsigned char>(blueLerp[colorIndex].second);
+		auto low = std::numeric_limits<double>::infinity();
+		auto high = -low;
+		for (auto corner : { Point4D{ static_cast<double>(bounds.x), static_cast<double>(bounds.y), 0, 1 },
+							 Point4D{ static_cast<double>(bounds.right()), static_cast<double>(bounds.bottom()), 0, 1 } })
+		{
+			auto major = toFirstOctant(octant, corner).x;
+			low = std::min(low, major);
+			high = std::max(high, major);
+		}
 
-		return Color{ r, g, b };
+		auto steps = std::max(std::trunc(point2.x - point1.x), 0.0);
+		auto first = std::max(0.0, std::floor(low - point1.x) - 1);
+		auto last = std::min(steps, std::ceil(high - point1.x) + 1);
+		return { first, std::max(first, last) };
 	}
 
-	std::vector<Point4D> generateLinePoints(const Point4D& p1, const Point4D & p2)
+	void generateLinePoints(const Point4D& p1, const Point4D & p2, const Rect& bounds, ArenaVector<Point4D>& result)
 	{
 		auto octant = getOctant(p2 - p1);
 		auto point1 = toFirstOctant(octant, p1);
 		auto point2 = toFirstOctant(octant, p2);
 
-		auto colorLerps = getColorLerp(point1, point2);
-		Lerp<decltype(point1.x)> posLerp(point1.x, point2.x, point1.y, point2.y);
-		Lerp<decltype(point1.x)> zLerp(point1.x, point2.x, point1.z, point2.z);
-
-		std::vector<Point4D> result;
-		result.reserve(posLerp.size());
-		auto currentIndex = 0;
-		std::generate_n(std::back_inserter(result), 
-						posLerp.size(),
-						[&posLerp, &zLerp, &colorLerps, &currentIndex, octant]
-						{
-							auto point = posLerp[currentIndex];
-							auto x = point.first;
-							auto y = point.second;
-							auto z = zLerp[currentIndex].second;
-							auto newColor = getColorFromLerp(currentIndex, colorLerps);
-							auto screenPoint = fromFirstOctant(octant, Point4D{ x, y, z, 1.0, newColor });
-							++currentIndex;
-							return screenPoint;
-						});
-
-		return result;
+		// One point per x step. y is begin + i * slope without accumulating, so
+		// edges land on the same pixels at any distance from the viewport
+		auto steps = std::max(std::trunc(point2.x - point1.x), 0.0);
+		auto [first, last] = visibleLineSteps(octant, point1, point2, bounds);
+		SteppedLerp<1> yLerp({ point1.y }, { point2.y }, steps);
+		SteppedLerp<4> attributeLerp({ point1.z, point1.color.r, point1.color.g, point1.color.b },
+									 { point2.z, point2.color.r, point2.color.g, point2.color.b }, steps);
+		yLerp.advanceTo(first);
+		attributeLerp.advanceTo(first);
+
+		result.reserve(result.size() + static_cast<std::size_t>(last - first));
+		for (auto i = first; i < last; ++i)
+		{
+			auto& attributes = attributeLerp.value();
+			auto color = FloatColor{ static_cast<float>(attributes[1]), static_cast<float>(attributes[2]), static_cast<float>(attributes[3]) };
+			result.push_back(fromFirstOctant(octant, Point4D{ point1.x + i, yLerp[0], attributes[0], 1.0, color }));
+
+			yLerp.advance();
+			attributeLerp.advance();
+		}
 	}
 
 	// Polygon helpers
@@ -314,16 +299,86 @@ namespace PointGenerator
 		return std::fma((p.x - p1.x), (p2.y - p1.y), -((p.y - p1.y) * (p2.x - p1.x)));
 	}
 
-	std::vector<Point4D> generateTrianglePoints(const std::vector<Point4D>& vertices)
+	// Perspective correct attributes at a pixel, w0..w2 already divided by the area
+	Point4D interpolateTriangle(const std::array<Point4D, 3>& vertices, double x, double y, double w0, double w1, double w2)
 	{
-		auto minX = std::floor((*std::min_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.x < b.x; })).x);
-		auto minY = std::floor((*std::min_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.y < b.y; })).y);
-		auto maxX = std::ceil((*std::max_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.x < b.x; })).x);
-		auto maxY = std::ceil((*std::max_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.y < b.y; })).y);
+		auto z0 = 1 / vertices[0].z;
+		auto z1 = 1 / vertices[1].z;
+		auto z2 = 1 / vertices[2].z;
 
-		auto area = edgeFunction(vertices[0], vertices[1], vertices[2]);
+		auto oneOverZ = std::fma(z0, w0, std::fma(z1, w1, z2 * w2));
+		auto z = 1.0 / oneOverZ;
+
+		auto color = vertices[0].color * w0 + vertices[1].color * w1 + vertices[2].color * w2;
+		auto point = Point4D{ x, y, z, 1.0, color};
+
+		if (std::all_of(vertices.begin(), vertices.end(), [](auto& v) {return v.normal.has_value(); }))
+		{
+			auto normal = normalize(vertices[0].normal.value() * w0 + vertices[1].normal.value() * w1 + vertices[2].normal.value() * w2);
+			point.normal = Point(normal.x, normal.y, normal.z);
+		}
+		
+		if (std::all_of(vertices.begin(), vertices.end(), [](auto& v) {return v.cameraSpacePoint.has_value(); }))
+		{
+			auto cameraPoint = vertices[0].cameraSpacePoint.value() * w0 + vertices[1].cameraSpacePoint.value() * w1 + vertices[2].cameraSpacePoint.value() * w2;
+			point.cameraSpacePoint = cameraPoint;
+		}
 
-		std::vector<Point4D> result;
+		return point;
+	}
+
+	// Upper bound of the pixels the triangle traversals keep, from the span of
+	// every column. margin widens each span, it absorbs rounding and, for
+	// samples, the offset of a sample from its pixel
+	std::size_t countTrianglePoints(const std::array<Point4D, 3>& vertices, const Rect& bounds, double margin)
+	{
+		auto minX = std::max(std::floor((*std::min_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.x < b.x; })).x), static_cast<double>(bounds.x));
+		auto minY = std::max(std::floor((*std::min_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.y < b.y; })).y), static_cast<double>(bounds.y));
+		auto maxX = std::min(std::ceil((*std::max_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.x < b.x; })).x), static_cast<double>(bounds.right() - 1));
+		auto maxY = std::min(std::ceil((*std::max_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.y < b.y; })).y), static_cast<double>(bounds.bottom() - 1));
+
+		std::size_t count = 0;
+		for (auto x = minX; x <= maxX; ++x)
+		{
+			auto low = minY;
+			auto high = maxY;
+			for (auto i = 0u; i < 3; ++i)
+			{
+				// Along the column the edge function is a + b * y, a point is kept where it is <= 0
+				auto& p1 = vertices[i];
+				auto& p2 = vertices[(i + 1) % 3];
+				auto a = (x - p1.x) * (p2.y - p1.y) + p1.y * (p2.x - p1.x);
+				auto b = -(p2.x - p1.x);
+				if (b > 0)
+				{
+					high = std::min(high, std::floor(-a / b + margin));
+				}
+				else if (b < 0)
+				{
+					low = std::max(low, std::ceil(-a / b - margin));
+				}
+				else if (a > 0)
+				{
+					high = low - 1;
+				}
+			}
+
+			if (high >= low)
+			{
+				count += static_cast<std::size_t>(high - low) + 1;
+			}
+		}
+		return count;
+	}
+
+	void generateTrianglePoints(const std::array<Point4D, 3>& vertices, const Rect& bounds, ArenaVector<Point4D>& result)
+	{
+		auto minX = std::max(std::floor((*std::min_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.x < b.x; })).x), static_cast<double>(bounds.x));
+		auto minY = std::max(std::floor((*std::min_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.y < b.y; })).y), static_cast<double>(bounds.y));
+		auto maxX = std::min(std::ceil((*std::max_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.x < b.x; })).x), static_cast<double>(bounds.right() - 1));
+		auto maxY = std::min(std::ceil((*std::max_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.y < b.y; })).y), static_cast<double>(bounds.bottom() - 1));
+
+		auto area = edgeFunction(vertices[0], vertices[1], vertices[2]);
 
 		for (auto x = minX; x <= maxX; ++x)
 		{
@@ -336,68 +391,95 @@ namespace PointGenerator
 
 				if (w0 <= 0 && w1 <= 0 && w2 <= 0)
 				{
-					w0 /= area;
-					w1 /= area;
-					w2 /= area;
-					
-					auto z0 = 1 / vertices[0].z;
-					auto z1 = 1 / vertices[1].z;
-					auto z2 = 1 / vertices[2].z;
+					result.push_back(interpolateTriangle(vertices, x, y, w0 / area, w1 / area, w2 / area));
+				}
+			}
+		}
+	}
 
-					auto oneOverZ = std::fma(z0, w0, std::fma(z1, w1, z2 * w2));
-					auto z = 1.0 / oneOverZ;
+	// Same traversal, but a pixel is kept when any of its samples is inside.
+	// Attributes are still taken at the pixel center, only depth is per sample
+	void generateTriangleSamples(const std::array<Point4D, 3>& vertices, const Rect& bounds, const SampleOffsets_t& offsets, ArenaVector<Point4D>& result, ArenaVector<SampleCoverage>& coverage)
+	{
+		auto minX = std::max(std::floor((*std::min_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.x < b.x; })).x), static_cast<double>(bounds.x));
+		auto minY = std::max(std::floor((*std::min_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.y < b.y; })).y), static_cast<double>(bounds.y));
+		auto maxX = std::min(std::ceil((*std::max_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.x < b.x; })).x), static_cast<double>(bounds.right() - 1));
+		auto maxY = std::min(std::ceil((*std::max_element(vertices.begin(), vertices.end(), [](const auto& a, const auto& b) {return a.y < b.y; })).y), static_cast<double>(bounds.bottom() - 1));
 
-					auto color = vertices[0].color * w0 + vertices[1].color * w1 + vertices[2].color * w2;
-					auto point = Point4D{ x, y, z, 1.0, color};
+		auto area = edgeFunction(vertices[0], vertices[1], vertices[2]);
 
-					if (std::all_of(vertices.begin(), vertices.end(), [](auto& v) {return v.normal.has_value(); }))
-					{
-						auto normal = normalize(vertices[0].normal.value() * w0 + vertices[1].normal.value() * w1 + vertices[2].normal.value() * w2);
-						point.normal = Point(normal.x, normal.y, normal.z);
-					}
-					
-					if (std::all_of(vertices.begin(), vertices.end(), [](auto& v) {return v.cameraSpacePoint.has_value(); }))
+		// 1/z is affine in screen space, so one slope per axis serves every sample
+		auto oneOverZAt = [&vertices, area](double x, double y)
+		{
+			Point4D p{ x, y, 0.0, 1.0 };
+			return (edgeFunction(vertices[1], vertices[2], p) / vertices[0].z + edgeFunction(vertices[2], vertices[0], p) / vertices[1].z + edgeFunction(vertices[0], vertices[1], p) / vertices[2].z) / area;
+		};
+		auto oneOverZ = oneOverZAt(0.0, 0.0);
+		auto oneOverZdx = oneOverZAt(1.0, 0.0) - oneOverZ;
+		auto oneOverZdy = oneOverZAt(0.0, 1.0) - oneOverZ;
+
+		for (auto x = minX; x <= maxX; ++x)
+		{
+			for (auto y = minY; y <= maxY; ++y)
+			{
+				auto mask = 0u;
+				for (auto i = 0u; i < offsets.size(); ++i)
+				{
+					Point4D sample{ x + offsets[i][0], y + offsets[i][1], 0.0, 1.0 };
+					if (edgeFunction(vertices[1], vertices[2], sample) <= 0 && edgeFunction(vertices[2], vertices[0], sample) <= 0 && edgeFunction(vertices[0], vertices[1], sample) <= 0)
 					{
-						auto cameraPoint = vertices[0].cameraSpacePoint.value() * w0 + vertices[1].cameraSpacePoint.value() * w1 + vertices[2].cameraSpacePoint.value() * w2;
-						point.cameraSpacePoint = cameraPoint;
+						mask |= 1u << i;
 					}
+				}
 
-					result.push_back(point);
+				if (mask != 0)
+				{
+					Point4D p{ x, y, 0.0, 1.0 };
+					auto w0 = edgeFunction(vertices[1], vertices[2], p) / area;
+					auto w1 = edgeFunction(vertices[2], vertices[0], p) / area;
+					auto w2 = edgeFunction(vertices[0], vertices[1], p) / area;
+
+					result.push_back(interpolateTriangle(vertices, x, y, w0, w1, w2));
+					coverage.push_back(SampleCoverage{ mask, oneOverZdx, oneOverZdy });
 				}
 			}
 		}
-
-		return result;
 	}
 
-	std::vector<Point4D> generatePolygonPoints(const std::vector<Point4D>& points)
+	void generatePolygonPoints(const ArenaVector<Point4D>& points, const Rect& bounds, ArenaVector<Point4D>& result)
 	{
 		auto vertices = sortVertices(points);
-		std::vector<Point4D> result;
 
-		if (vertices.size() > 3)
+		// Reserved up front, a growing vector would leave its old storage behind in the arena
+		auto count = result.size();
+		for (auto i = 1u; i < vertices.size() - 1; ++i)
 		{
-			std::vector<std::vector<Point4D>> triangles;
-			for (auto i = 1u; i < vertices.size() - 1; ++i)
-			{
-				std::vector<Point4D> triangle;
-				triangle.push_back(vertices[0]);
-				triangle.push_back(vertices[i]);
-				triangle.push_back(vertices[i + 1]);
-				triangles.push_back(triangle);
-			}
+			count += countTrianglePoints({ vertices[0], vertices[i], vertices[i + 1] }, bounds, 1.0);
+		}
+		result.reserve(count);
 
-			for (auto& triangle : triangles)
-			{
-				auto trianglePoints = generateTrianglePoints(triangle);
-				result.insert(result.end(), trianglePoints.begin(), trianglePoints.end());
-			}
+		// Fan out from the first vertex
+		for (auto i = 1u; i < vertices.size() - 1; ++i)
+		{
+			generateTrianglePoints({ vertices[0], vertices[i], vertices[i + 1] }, bounds, result);
+		}
+	}
+
+	void generatePolygonSamples(const ArenaVector<Point4D>& points, const Rect& bounds, const SampleOffsets_t& offsets, ArenaVector<Point4D>& result, ArenaVector<SampleCoverage>& coverage)
+	{
+		auto vertices = sortVertices(points);
 
-			return result;
+		auto count = result.size();
+		for (auto i = 1u; i < vertices.size() - 1; ++i)
+		{
+			count += countTrianglePoints({ vertices[0], vertices[i], vertices[i + 1] }, bounds, 2.0);
 		}
-		else
+		result.reserve(count);
+		coverage.reserve(coverage.size() + count - result.size());
+
+		for (auto i = 1u; i < vertices.size() - 1; ++i)
 		{
-			return generateTrianglePoints(vertices);
+			generateTriangleSamples({ vertices[0], vertices[i], vertices[i + 1] }, bounds, offsets, result, coverage);
 		}
 	}
 
@@ -499,12 +581,22 @@ namespace PointGenerator
 	//	return result;
 	//}
 
-	std::vector<Point4D> generateWireframePoints(const std::vector<Point4D>& points)
+	void generateWireframePoints(const ArenaVector<Point4D>& points, const Rect& bounds, ArenaVector<Point4D>& result)
 	{
 		//auto sortedVertices = sortVertices(points, comparePoints);
 		auto sortedVertices = sortVertices(points);
-		
-		std::vector<Point4D> result;
+
+		// One point per step along the major axis of every edge
+		auto count = result.size();
+		for (auto i = 0u; i < sortedVertices.size(); ++i)
+		{
+			auto& p1 = sortedVertices[i];
+			auto& p2 = sortedVertices[(i + 1) % sortedVertices.size()];
+			auto octant = getOctant(p2 - p1);
+			auto [first, last] = visibleLineSteps(octant, toFirstOctant(octant, p1), toFirstOctant(octant, p2), bounds);
+			count += static_cast<std::size_t>(last - first);
+		}
+		result.reserve(count);
 
 		for (auto i = 0u; i < sortedVertices.size(); ++i)
 		{
@@ -513,10 +605,7 @@ namespace PointGenerator
 			{
 				j = 0;
 			}
-			auto linePoints = generateLinePoints(sortedVertices[i], sortedVertices[j]);
-			result.insert(result.end(), linePoints.begin(), linePoints.end());
+			generateLinePoints(sortedVertices[i], sortedVertices[j], bounds, result);
 		}
-
-		return result;
 	}
 }
@@ -1,9 +1,15 @@
 #pragma once
 #include <vector>
+#include "Arena.hpp"
+#include "MultisampleBuffer.hpp"
 #include "primitives.hpp"
 namespace PointGenerator
 {
-	std::vector<Point4D> generateLinePoints(const Point4D& p1, const Point4D& p2);
-	std::vector<Point4D> generatePolygonPoints(const std::vector<Point4D>& points);
-	std::vector<Point4D> generateWireframePoints(const std::vector<Point4D>& points);
+	// Generated points are appended to result, lines skip the steps that cannot land in bounds
+	void generateLinePoints(const Point4D& p1, const Point4D& p2, const Rect& bounds, ArenaVector<Point4D>& result);
+	// Only the pixels inside bounds are generated
+	void generatePolygonPoints(const ArenaVector<Point4D>& points, const Rect& bounds, ArenaVector<Point4D>& result);
+	// coverage gets which of the samples in offsets each point covers, in step with result
+	void generatePolygonSamples(const ArenaVector<Point4D>& points, const Rect& bounds, const SampleOffsets_t& offsets, ArenaVector<Point4D>& result, ArenaVector<SampleCoverage>& coverage);
+	void generateWireframePoints(const ArenaVector<Point4D>& points, const Rect& bounds, ArenaVector<Point4D>& result);
 }
\ No newline at end of file
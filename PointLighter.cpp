@@ -1,22 +1,15 @@
 #include "PointLighter.hpp"
-#include "lerp.hpp"
 
-void PointLighter::calculateAmbientLight(std::vector<Point4D>& points, const Color& ambientColor)
+#include <algorithm>
+#include <array>
+#include <limits>
+
+void PointLighter::calculateAmbientLight(ArenaVector<Point4D>& points, const Color& ambientColor)
 {
-	auto colorChannels = ambientColor.getNormalizedColorChannels();
-	auto ambientRed = std::get<0>(colorChannels);
-	auto ambientGreen = std::get<1>(colorChannels);
-	auto ambientBlue = std::get<2>(colorChannels);
-	
+	auto ambient = FloatColor{ ambientColor };
 	for (auto& point : points)
 	{
-		auto pointColorChannels = point.color.getNormalizedColorChannels();
-		auto pointRed = std::get<0>(pointColorChannels);
-		auto pointGreen = std::get<1>(pointColorChannels);
-		auto pointBlue = std::get<2>(pointColorChannels);
-
-		auto newColor = Color::getDenormalizedColor(ambientRed * pointRed, ambientGreen * pointGreen, ambientBlue * pointBlue);
-		point.color = newColor;
+		point.color = point.color * ambient;
 	}
 }
 
@@ -38,7 +31,7 @@ Point4D reflect(const Point4D& l, const Point4D& n)
 	return l - n * 2 * dot(l, n);
 }
 
-Color PointLighter::calculateLightAtPixel(const Point4D& p, const Point4D& vN, const Light& l, double ks, double kp)
+FloatColor PointLighter::calculateLightAtPixel(const Point4D& p, const Point4D& vN, const Light& l, double ks, const SpecularTable& specular)
 {
 	auto pl = Point4D{ l.Location[0], l.Location[1], l.Location[2], l.Location[3] };
 	auto vl = normalize(pl - p);
@@ -56,66 +49,204 @@ Color PointLighter::calculateLightAtPixel(const Point4D& p, const Point4D& vN, c
 		dotPR = 0;
 	}
 
-	auto lightColor = l.color * fatt(l.A, l.B, distance(pl, p)) * (p.color * dotNL + ks * std::pow(dotPR, kp));
+	auto highlight = static_cast<float>(ks * specular.lookup(static_cast<float>(dotPR)));
+	auto lightColor = FloatColor{ l.color } * fatt(l.A, l.B, distance(pl, p)) * (p.color * dotNL + FloatColor{ highlight, highlight, highlight });
 	return lightColor;
 }
 
-Color PointLighter::calculateLights(Point4D & p, std::vector<Light> & lights, double ks, double kp)
+FloatColor PointLighter::calculateLights(Point4D & p, const ArenaVector<Light> & lights, double ks, const SpecularTable& specular)
 {
 	auto vN = normalize(p.normal.value());
-	Color c{ 0.0 };
+	FloatColor c;
 	for (auto& l : lights)
 	{
-		c = c + calculateLightAtPixel(p, vN, l, ks, kp);
+		c = c + calculateLightAtPixel(p, vN, l, ks, specular);
 	}
 	return c;
 }
 
-void PointLighter::calculateLighting(std::vector<Point4D>& points, const Color & ambientColor, std::vector<Light>& lights, double ks, double kp)
+namespace
 {
-	Color pointColor{ 255, 255, 255 };
-	auto ambientTerm = pointColor * ambientColor;
+	// Fragments shaded together, the lane loops below are written so the
+	// compiler can keep a whole block in vector registers
+	constexpr std::size_t blockSize = 8;
+	using Lanes = std::array<float, blockSize>;
 
-	for (auto& p : points)
+	inline
+	float inverseSqrt(float x)
 	{
-		p.color = ambientTerm + calculateLights(p, lights, ks, kp);
+		return 1.0f / std::sqrt(x);
+	}
+
+	struct FragmentBlock
+	{
+		Lanes x, y, z;
+		Lanes nx, ny, nz;
+		Lanes red, green, blue;
+	};
+
+	void shadeBlock(const FragmentBlock& block, const ArenaVector<Light>& lights, float ks, const SpecularTable& specular, FragmentBlock& result)
+	{
+		result.red.fill(0.0f);
+		result.green.fill(0.0f);
+		result.blue.fill(0.0f);
+
+		for (auto& l : lights)
+		{
+			auto lx = static_cast<float>(l.Location[0]);
+			auto ly = static_cast<float>(l.Location[1]);
+			auto lz = static_cast<float>(l.Location[2]);
+			auto lightColor = FloatColor{ l.color };
+			auto A = static_cast<float>(l.A);
+			auto B = static_cast<float>(l.B);
+
+			for (auto i = 0u; i < blockSize; ++i)
+			{
+				// Direction to the light
+				auto dx = lx - block.x[i];
+				auto dy = ly - block.y[i];
+				auto dz = lz - block.z[i];
+				auto distanceSquared = dx * dx + dy * dy + dz * dz;
+				auto inverseDistance = inverseSqrt(distanceSquared);
+				dx *= inverseDistance;
+				dy *= inverseDistance;
+				dz *= inverseDistance;
+
+				auto dotNL = block.nx[i] * dx + block.ny[i] * dy + block.nz[i] * dz;
+
+				// Reflection of the light direction against the view direction
+				auto rx = dx - block.nx[i] * 2.0f * dotNL;
+				auto ry = dy - block.ny[i] * 2.0f * dotNL;
+				auto rz = dz - block.nz[i] * 2.0f * dotNL;
+				auto inverseView = inverseSqrt(block.x[i] * block.x[i] + block.y[i] * block.y[i] + block.z[i] * block.z[i]);
+				auto dotPR = std::max((block.x[i] * rx + block.y[i] * ry + block.z[i] * rz) * inverseView, 0.0f);
+
+				auto attenuation = 1.0f / (A + B * distanceSquared * inverseDistance);
+				auto diffuse = std::max(dotNL, 0.0f);
+				auto highlight = ks * specular.lookup(dotPR);
+
+				result.red[i] += lightColor.r * attenuation * (block.red[i] * diffuse + highlight);
+				result.green[i] += lightColor.g * attenuation * (block.green[i] * diffuse + highlight);
+				result.blue[i] += lightColor.b * attenuation * (block.blue[i] * diffuse + highlight);
+			}
+		}
 	}
 }
 
-void PointLighter::calculateDepthShading(std::vector<Point4D>& points, const Depth & depth)
+// Same lighting as calculateLights for every point that carries a camera
+// space position and normal, evaluated a block of fragments at a time
+void PointLighter::calculatePhongLighting(ArenaVector<Point4D>& points, const Color& ambientColor, const ArenaVector<Light>& lights, double ks, const SpecularTable& specular)
 {
-	auto zLerp = Lerp<double>(depth.near, depth.far, 0.0, 1.0);
+	auto ambient = FloatColor{ ambientColor };
+	std::array<Point4D*, blockSize> blockPoints;
+	FragmentBlock block;
+	FragmentBlock result;
 
-	for (auto& point : points)
+	auto flush = [&](std::size_t count)
+	{
+		// Unused lanes get a harmless fragment so they never produce NaNs
+		for (auto i = count; i < blockSize; ++i)
+		{
+			block.x[i] = 0.0f; block.y[i] = 0.0f; block.z[i] = 1.0f;
+			block.nx[i] = 0.0f; block.ny[i] = 0.0f; block.nz[i] = -1.0f;
+			block.red[i] = 0.0f; block.green[i] = 0.0f; block.blue[i] = 0.0f;
+		}
+
+		shadeBlock(block, lights, static_cast<float>(ks), specular, result);
+
+		for (auto i = 0u; i < count; ++i)
+		{
+			blockPoints[i]->color = blockPoints[i]->color * ambient + FloatColor{ result.red[i], result.green[i], result.blue[i] };
+		}
+	};
+
+	auto count = std::size_t{ 0 };
+	for (auto& p : points)
 	{
-		if (point.z > depth.far)
+		if (!p.normal.has_value())
+		{
+			continue;
+		}
+
+		auto& position = p.cameraSpacePoint.value();
+		auto& normal = p.normal.value();
+		auto inverseLength = inverseSqrt(static_cast<float>(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z));
+		auto color = FloatColor{ position.color };
+
+		block.x[count] = static_cast<float>(position.x);
+		block.y[count] = static_cast<float>(position.y);
+		block.z[count] = static_cast<float>(position.z);
+		block.nx[count] = static_cast<float>(normal.x) * inverseLength;
+		block.ny[count] = static_cast<float>(normal.y) * inverseLength;
+		block.nz[count] = static_cast<float>(normal.z) * inverseLength;
+		block.red[count] = color.r;
+		block.green[count] = color.g;
+		block.blue[count] = color.b;
+		blockPoints[count] = &p;
+
+		if (++count == blockSize)
 		{
-			point.color = depth.color;
+			flush(count);
+			count = 0;
 		}
-		else if (point.z > depth.near)
+	}
+
+	if (count > 0)
+	{
+		flush(count);
+	}
+}
+
+// A light contributes at most its brightest channel * (1 + ks) / (A + B * d).
+// Past the distance where that drops below half a color step split over all
+// lightCount lights it is skipped, so even every culled light together stays
+// under half a step
+double PointLighter::calculateLightRadius(const Light& l, double ks, std::size_t lightCount)
+{
+	auto channels = l.color.getNormalizedColorChannels();
+	auto maxChannel = std::max({ std::get<0>(channels), std::get<1>(channels), std::get<2>(channels) });
+	auto reach = 2.0 * 255.0 * maxChannel * (1.0 + std::abs(ks)) * std::max<std::size_t>(lightCount, 1);
+
+	if (maxChannel == 0)
+	{
+		return -std::numeric_limits<double>::infinity();
+	}
+
+	if (l.B <= 0)
+	{
+		return l.A > reach ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+	}
+
+	return (reach - l.A) / l.B;
+}
+
+// Keeps the lights whose radius reaches the bounding sphere of the shaded points
+void PointLighter::cullLights(const std::vector<Light>& lights, double ks, const ArenaVector<Point4D>& shadedPoints, ArenaVector<Light>& result)
+{
+	auto center = getCenterPoint(shadedPoints);
+	auto boundingRadius = 0.0;
+	for (auto& p : shadedPoints)
+	{
+		boundingRadius = std::max(boundingRadius, distance(center, p));
+	}
+
+	result.reserve(lights.size());
+	for (auto& l : lights)
+	{
+		auto pl = Point4D{ l.Location[0], l.Location[1], l.Location[2], l.Location[3] };
+		if (distance(pl, center) - boundingRadius <= calculateLightRadius(l, ks, lights.size()))
 		{
-			auto depthColorFactor = zLerp[static_cast<int>(point.z - depth.near)].second;
-			auto depthColorChannels = depth.color.getNormalizedColorChannels();
-			auto pointColorChannels = point.color.getNormalizedColorChannels();
-			auto newRed = ((1 - depthColorFactor) * std::get<0>(pointColorChannels)) + (depthColorFactor * std::get<0>(depthColorChannels));
-			auto newGreen = ((1 - depthColorFactor) * std::get<1>(pointColorChannels)) + (depthColorFactor * std::get<1>(depthColorChannels));
-			auto newBlue = ((1 - depthColorFactor) * std::get<2>(pointColorChannels)) + (depthColorFactor * std::get<2>(depthColorChannels));
-
-			point.color = Color::getDenormalizedColor(newRed, newGreen, newBlue);
+			result.push_back(l);
 		}
 	}
 }
 
-//for (auto& point : points)
-//{
-//	if (point.z > depth.far)
-//	{
-//		point.color = depth.color;
-//	}
-//	else if (point.z > depth.near)
-//	{
-//		auto factor = (point.z - depth.near) / (depth.far - depth.near);
-//		auto newColor = point.color * factor + (1 - factor) * depth.color;
-//		point.color = newColor;
-//	}
-//}
\ No newline at end of file
+void PointLighter::calculateLighting(ArenaVector<Point4D>& points, const Color & ambientColor, const ArenaVector<Light>& lights, double ks, const SpecularTable& specular)
+{
+	auto ambientTerm = FloatColor{ ambientColor };
+
+	for (auto& p : points)
+	{
+		p.color = ambientTerm + calculateLights(p, lights, ks, specular);
+	}
+}
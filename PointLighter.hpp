@@ -1,14 +1,18 @@
 #pragma once
 #include <vector>
+#include "Arena.hpp"
 #include "primitives.hpp"
 #include "Depth.hpp"
 #include "Light.hpp"
+#include "SpecularTable.hpp"
 
 namespace PointLighter
 {
-	void calculateAmbientLight(std::vector<Point4D>& points, const Color& ambientColor);
-	void calculateLighting(std::vector<Point4D>& points, const Color& ambientColor, std::vector<Light>& lights, double ks, double kp);
-	Color calculateLightAtPixel(const Point4D& p, const Point4D& vN, const Light& l, double ks, double kp);
-	Color calculateLights(Point4D & p, std::vector<Light> & lights, double ks, double kp);
-	void calculateDepthShading(std::vector<Point4D>& points, const Depth& depth);
+	void calculateAmbientLight(ArenaVector<Point4D>& points, const Color& ambientColor);
+	void calculateLighting(ArenaVector<Point4D>& points, const Color& ambientColor, const ArenaVector<Light>& lights, double ks, const SpecularTable& specular);
+	FloatColor calculateLightAtPixel(const Point4D& p, const Point4D& vN, const Light& l, double ks, const SpecularTable& specular);
+	FloatColor calculateLights(Point4D & p, const ArenaVector<Light> & lights, double ks, const SpecularTable& specular);
+	void calculatePhongLighting(ArenaVector<Point4D>& points, const Color& ambientColor, const ArenaVector<Light>& lights, double ks, const SpecularTable& specular);
+	double calculateLightRadius(const Light& l, double ks, std::size_t lightCount);
+	void cullLights(const std::vector<Light>& lights, double ks, const ArenaVector<Point4D>& shadedPoints, ArenaVector<Light>& result);
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "PointsRenderer.hpp"
+#include "lerp.hpp"
 
 namespace PointsRenderer
 {
@@ -14,23 +15,32 @@ namespace PointsRenderer
 		return x >= rect.x && x < rect.right() && y >= rect.y && y < rect.bottom();
 	}
 
-	// Draw to surface
-	void drawToSurface(const Point4D& screenPoint, Drawable* drawSurface, const Color& colorToPaint)
+	// Draw to surface, the only place a fragment color is quantized
+	void drawToSurface(const Point4D& screenPoint, Drawable* drawSurface, const FloatColor& colorToPaint)
 	{
 		drawSurface->setPixel(static_cast<int>(std::round(screenPoint.x)), static_cast<int>(std::round(screenPoint.y)), colorToPaint.asUnsigned());
 	}
 
-	void drawPixel(const Point4D& screenPoint, Drawable* drawSurface, const Color& colorToPaint, Matrix2D<double>& zBuffer, const Rect& viewPort, const Camera& camera)
+	void drawPixel(const Point4D& screenPoint, Drawable* drawSurface, const FloatColor& colorToPaint, Matrix2D<double>& zBuffer, const Rect& viewPort, const Camera& camera, const std::optional<DepthCue>& depthCue)
 	{
-		auto x = static_cast<int>(std::round(screenPoint.x - viewPort.x));
-		auto y = static_cast<int>(std::round(screenPoint.y - viewPort.y));
+		auto x = static_cast<int>(std::round(screenPoint.x)) - viewPort.x;
+		auto y = static_cast<int>(std::round(screenPoint.y)) - viewPort.y;
 		auto currentZ = zBuffer[x][y];
 		auto newZ = std::round(screenPoint.z);
 		//auto newZ = screenPoint.z;
 		if (newZ < currentZ && newZ >= camera.near)
 		{
 			zBuffer[x][y] = newZ;
-			drawToSurface(screenPoint, drawSurface, colorToPaint);
+
+			// Depth cue only the fragments that survive the depth test
+			if (depthCue.has_value())
+			{
+				drawToSurface(screenPoint, drawSurface, depthCue->apply(colorToPaint, screenPoint.z));
+			}
+			else
+			{
+				drawToSurface(screenPoint, drawSurface, colorToPaint);
+			}
 		}
 		else
 		{
@@ -39,15 +49,190 @@ namespace PointsRenderer
 		}
 	}
 
-	void PointsRenderer::renderPoints(const std::vector<Point4D>& points, Drawable * drawSurface, Matrix2D<double>& zBuffer, const Rect & viewPort, const Camera& camera)
+	void renderPoints(const ArenaVector<Point4D>& points, Drawable * drawSurface, Matrix2D<double>& zBuffer, const Rect & viewPort, const Camera& camera, const std::optional<DepthCue>& depthCue)
 	{
 		for (const auto& point : points)
 		{
 			if (pointInRect(point, viewPort))
 			{
-				drawPixel(point, drawSurface, point.color, zBuffer, viewPort, camera);
+				drawPixel(point, drawSurface, point.color, zBuffer, viewPort, camera, depthCue);
+			}
+		}
+	}
+
+	void renderSamples(const ArenaVector<Point4D>& points, const ArenaVector<SampleCoverage>& coverage, Drawable* drawSurface, Matrix2D<double>& zBuffer, MultisampleBuffer& sampleBuffer, const Rect& viewPort, const Camera& camera, const std::optional<DepthCue>& depthCue)
+	{
+		auto& offsets = sampleBuffer.offsets();
+		for (auto index = 0u; index < points.size(); ++index)
+		{
+			auto& point = points[index];
+			if (!pointInRect(point, viewPort))
+			{
+				continue;
+			}
+
+			if (coverage.empty())
+			{
+				drawPixel(point, drawSurface, point.color, zBuffer, viewPort, camera, depthCue);
+				continue;
+			}
+
+			auto x = static_cast<int>(std::round(point.x)) - viewPort.x;
+			auto y = static_cast<int>(std::round(point.y)) - viewPort.y;
+			auto screenX = static_cast<int>(std::round(point.x));
+			auto screenY = static_cast<int>(std::round(point.y));
+			sampleBuffer.touch(x, y, getCurrentColor(screenX, screenY, drawSurface), zBuffer[x][y]);
+
+			// Shaded once, the depth cue uses the pixel center depth
+			auto color = depthCue.has_value() ? depthCue->apply(point.color, point.z) : point.color;
+			auto& samples = coverage[index];
+			auto oneOverZ = 1.0 / point.z;
+			auto written = false;
+			for (auto i = 0; i < sampleBuffer.sampleCount(); ++i)
+			{
+				if ((samples.mask & (1u << i)) == 0)
+				{
+					continue;
+				}
+
+				auto z = 1.0 / (oneOverZ + samples.oneOverZdx * offsets[i][0] + samples.oneOverZdy * offsets[i][1]);
+				auto newZ = std::round(z);
+				auto& sampleZ = sampleBuffer.depth(x, y, i);
+				if (newZ < sampleZ && newZ >= camera.near)
+				{
+					sampleZ = newZ;
+					sampleBuffer.color(x, y, i) = color;
+					written = true;
+				}
+			}
+
+			if (written)
+			{
+				auto farthestZ = 0.0;
+				drawToSurface(point, drawSurface, sampleBuffer.resolve(x, y, farthestZ));
+				zBuffer[x][y] = farthestZ;
+			}
+		}
+	}
+
+	// Blends a partially covered pixel over what is already on the surface. Only
+	// pixels the line mostly covers write depth, so faint fringes never hide
+	// geometry drawn later
+	void blendPixel(const Point4D& screenPoint, Drawable* drawSurface, double coverage, Matrix2D<double>& zBuffer, const Rect& viewPort, const Camera& camera, const std::optional<DepthCue>& depthCue)
+	{
+		if (coverage <= 0.0 || !pointInRect(screenPoint, viewPort) || screenPoint.z < camera.near || screenPoint.z > camera.far)
+		{
+			return;
+		}
+
+		auto x = static_cast<int>(std::round(screenPoint.x)) - viewPort.x;
+		auto y = static_cast<int>(std::round(screenPoint.y)) - viewPort.y;
+		auto newZ = std::round(screenPoint.z);
+		if (newZ < zBuffer[x][y] && newZ >= camera.near)
+		{
+			if (coverage >= 0.5)
+			{
+				zBuffer[x][y] = newZ;
+			}
+
+			auto color = depthCue.has_value() ? depthCue->apply(screenPoint.color, screenPoint.z) : screenPoint.color;
+			auto screenX = static_cast<int>(std::round(screenPoint.x));
+			auto screenY = static_cast<int>(std::round(screenPoint.y));
+			auto oldColor = Color{ drawSurface->getPixel(screenX, screenY) };
+			drawSurface->setPixel(screenX, screenY, colorWithOpacity(color.toColor(), oldColor, coverage).asUnsigned());
+		}
+	}
+
+	// Walks the line straight into the buffers without collecting points. It
+	// steps like generateLinePoints but also draws the end point, so an edge
+	// drawn once is complete on its own
+	void renderLine(const Point4D& p1, const Point4D& p2, Drawable* drawSurface, Matrix2D<double>& zBuffer, const Rect& viewPort, const Camera& camera, const std::optional<DepthCue>& depthCue)
+	{
+		// One pixel per step along the longer axis, ties step along x
+		auto yMajor = std::abs(p2.x - p1.x) < std::abs(p2.y - p1.y);
+		auto majorStart = yMajor ? p1.y : p1.x;
+		auto majorDelta = yMajor ? p2.y - p1.y : p2.x - p1.x;
+		auto direction = majorDelta > 0 ? 1.0 : -1.0;
+		auto steps = std::floor(std::abs(majorDelta));
+
+		// Only the steps that can land in the viewport are walked, lines are
+		// not near clipped and can reach far past it. The lerps evaluate every
+		// step afresh, so starting part way gives the same pixels
+		auto toLow = direction * ((yMajor ? viewPort.y : viewPort.x) - majorStart);
+		auto toHigh = direction * ((yMajor ? viewPort.bottom() : viewPort.right()) - majorStart);
+		auto first = std::max(0.0, std::floor(std::min(toLow, toHigh)) - 1);
+		auto last = std::min(steps, std::ceil(std::max(toLow, toHigh)) + 1);
+
+		SteppedLerp<1> minorLerp({ yMajor ? p1.x : p1.y }, { yMajor ? p2.x : p2.y }, steps);
+		SteppedLerp<4> attributeLerp({ p1.z, p1.color.r, p1.color.g, p1.color.b },
+									 { p2.z, p2.color.r, p2.color.g, p2.color.b }, steps);
+		minorLerp.advanceTo(first);
+		attributeLerp.advanceTo(first);
+
+		for (auto i = first; i <= last; ++i)
+		{
+			auto major = majorStart + direction * i;
+			auto minor = minorLerp[0];
+			auto& attributes = attributeLerp.value();
+			auto color = FloatColor{ static_cast<float>(attributes[1]), static_cast<float>(attributes[2]), static_cast<float>(attributes[3]) };
+			auto point = Point4D{ yMajor ? minor : major, yMajor ? major : minor, attributes[0], 1.0, color };
+
+			if (pointInRect(point, viewPort))
+			{
+				drawPixel(point, drawSurface, point.color, zBuffer, viewPort, camera, depthCue);
 			}
+
+			minorLerp.advance();
+			attributeLerp.advance();
 		}
 	}
-}
 
+	// Xiaolin Wu style: each step along the major axis splits the line between
+	// the two pixels straddling it, in proportion to how close it passes
+	void renderAntialiasedLine(const Point4D& p1, const Point4D& p2, Drawable* drawSurface, Matrix2D<double>& zBuffer, const Rect& viewPort, const Camera& camera, const std::optional<DepthCue>& depthCue)
+	{
+		auto yMajor = std::abs(p2.x - p1.x) < std::abs(p2.y - p1.y);
+		auto majorOf = [yMajor](const Point4D& p) { return yMajor ? p.y : p.x; };
+		auto minorOf = [yMajor](const Point4D& p) { return yMajor ? p.x : p.y; };
+
+		// Always walk forward along the major axis
+		auto& start = majorOf(p1) <= majorOf(p2) ? p1 : p2;
+		auto& end = majorOf(p1) <= majorOf(p2) ? p2 : p1;
+
+		auto majorStart = std::round(majorOf(start));
+		auto majorEnd = std::round(majorOf(end));
+		auto steps = majorEnd - majorStart;
+		auto majorLength = majorOf(end) - majorOf(start);
+		auto gradient = majorLength != 0 ? (minorOf(end) - minorOf(start)) / majorLength : 0.0;
+
+		// Minor coordinate where the line crosses the first pixel centre
+		auto minorStart = minorOf(start) + gradient * (majorStart - majorOf(start));
+
+		// Only the steps that can land in the viewport are walked, as in renderLine
+		auto toLow = (yMajor ? viewPort.y : viewPort.x) - majorStart;
+		auto toHigh = (yMajor ? viewPort.bottom() : viewPort.right()) - majorStart;
+		auto first = std::max(0.0, std::floor(toLow) - 1);
+		auto last = std::min(steps, std::ceil(toHigh) + 1);
+
+		SteppedLerp<4> attributeLerp({ start.z, start.color.r, start.color.g, start.color.b },
+									 { end.z, end.color.r, end.color.g, end.color.b }, steps);
+		attributeLerp.advanceTo(first);
+
+		for (auto i = first; i <= last; ++i)
+		{
+			auto major = majorStart + i;
+			auto minorPosition = minorStart + gradient * i;
+			auto minor = std::floor(minorPosition);
+			auto coverage = minorPosition - minor;
+			auto& attributes = attributeLerp.value();
+			auto color = FloatColor{ static_cast<float>(attributes[1]), static_cast<float>(attributes[2]), static_cast<float>(attributes[3]) };
+
+			auto near = Point4D{ yMajor ? minor : major, yMajor ? major : minor, attributes[0], 1.0, color };
+			auto far = Point4D{ yMajor ? minor + 1 : major, yMajor ? major : minor + 1, attributes[0], 1.0, color };
+			blendPixel(near, drawSurface, 1.0 - coverage, zBuffer, viewPort, camera, depthCue);
+			blendPixel(far, drawSurface, coverage, zBuffer, viewPort, camera, depthCue);
+
+			attributeLerp.advance();
+		}
+	}
+}
\ No newline at end of file
@@ -1,12 +1,21 @@
 #pragma once
+#include <optional>
 #include <vector>
 
+#include "Arena.hpp"
 #include "drawable.h"
 #include "primitives.hpp"
 #include "CommonTypeAliases.hpp"
 #include "Camera.hpp"
+#include "Depth.hpp"
+#include "MultisampleBuffer.hpp"
 
 namespace PointsRenderer
 {
-	void renderPoints(const std::vector<Point4D>& points, Drawable* drawSurface, Matrix2D<double>& zBuffer, const Rect& viewPort, const Camera& camera);
+	void renderPoints(const ArenaVector<Point4D>& points, Drawable* drawSurface, Matrix2D<double>& zBuffer, const Rect& viewPort, const Camera& camera, const std::optional<DepthCue>& depthCue);
+	// Points with sample coverage are depth tested per sample and resolved, the rest are drawn as usual
+	// coverage is empty or has one entry per point, points without coverage are drawn as single samples
+	void renderSamples(const ArenaVector<Point4D>& points, const ArenaVector<SampleCoverage>& coverage, Drawable* drawSurface, Matrix2D<double>& zBuffer, MultisampleBuffer& sampleBuffer, const Rect& viewPort, const Camera& camera, const std::optional<DepthCue>& depthCue);
+	void renderLine(const Point4D& p1, const Point4D& p2, Drawable* drawSurface, Matrix2D<double>& zBuffer, const Rect& viewPort, const Camera& camera, const std::optional<DepthCue>& depthCue);
+	void renderAntialiasedLine(const Point4D& p1, const Point4D& p2, Drawable* drawSurface, Matrix2D<double>& zBuffer, const Rect& viewPort, const Camera& camera, const std::optional<DepthCue>& depthCue);
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "RenderPipeline.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	// Large enough to amortize the hand over, small enough to start the workers early
+	constexpr std::size_t batchSize = 64;
+	constexpr std::size_t queueCapacity = 64;
+}
+
+RenderPipeline::Worker::Worker(const RenderEngine& renderEngine, const Rect& band) :
+	renderEngine(renderEngine),
+	surface(renderEngine.GetDrawSurface(), band),
+	queue(queueCapacity)
+{
+	this->renderEngine.SetDrawSurface(&surface);
+	this->renderEngine.SetClipRegion(band);
+	this->renderEngine.SetRasterBand(band);
+}
+
+RenderPipeline::RenderPipeline(const RenderEngine& renderEngine, int workerCount)
+{
+	auto& viewPort = renderEngine.GetViewPort();
+	workerCount = std::clamp(workerCount, 1, std::max(1, viewPort.height));
+	for (auto i = 0; i < workerCount; ++i)
+	{
+		auto top = viewPort.y + viewPort.height * i / workerCount;
+		auto bottom = viewPort.y + viewPort.height * (i + 1) / workerCount;
+		workers.push_back(std::make_unique<Worker>(renderEngine, Rect{ viewPort.x, top, viewPort.width, bottom - top }));
+	}
+
+	for (auto& worker : workers)
+	{
+		worker->thread = std::thread(work, std::ref(*worker));
+	}
+	pending.reserve(batchSize);
+}
+
+RenderPipeline::~RenderPipeline()
+{
+	finish();
+}
+
+void RenderPipeline::submit(RenderCall_t call)
+{
+	pending.push_back(std::move(call));
+	if (pending.size() == batchSize)
+	{
+		flush();
+	}
+}
+
+void RenderPipeline::finish()
+{
+	if (workers.empty() || !workers.front()->thread.joinable())
+	{
+		return;
+	}
+
+	flush();
+	for (auto& worker : workers)
+	{
+		// An empty batch ends the stream
+		auto end = Batch_t{};
+		while (!worker->queue.tryPush(end))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	for (auto& worker : workers)
+	{
+		worker->thread.join();
+	}
+}
+
+const RenderEngine& RenderPipeline::settings() const
+{
+	return workers.front()->renderEngine;
+}
+
+void RenderPipeline::flush()
+{
+	if (pending.empty())
+	{
+		return;
+	}
+
+	auto batch = std::make_shared<const std::vector<RenderCall_t>>(std::move(pending));
+	pending = std::vector<RenderCall_t>();
+	pending.reserve(batchSize);
+
+	for (auto& worker : workers)
+	{
+		auto shared = batch;
+		while (!worker->queue.tryPush(shared))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void RenderPipeline::work(Worker& worker)
+{
+	Batch_t batch;
+	while (true)
+	{
+		if (!worker.queue.tryPop(batch))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		if (!batch)
+		{
+			return;
+		}
+
+		for (auto& call : *batch)
+		{
+			call(worker.renderEngine);
+		}
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ClippedDrawable.hpp"
+#include "RenderingEngine.hpp"
+#include "SpscQueue.hpp"
+
+using RenderCall_t = std::function<void(RenderEngine&)>;
+
+// Raster stage of a pipelined frame. Calls are gathered into batches and
+// handed to every worker through its own bounded lock-free ring. Each worker
+// owns a band of the viewport and runs every batch in submission order on its
+// own copy of the engine, clipped to the band, so every pixel sees the same
+// sequence of primitives as a single threaded run. A copy only rasterizes and
+// buffers the pixels of its band. The draw surface has to
+// accept concurrent writes to different pixels.
+class RenderPipeline
+{
+public:
+	RenderPipeline(const RenderEngine& renderEngine, int workerCount);
+	~RenderPipeline();
+
+	RenderPipeline(const RenderPipeline&) = delete;
+	RenderPipeline& operator=(const RenderPipeline&) = delete;
+
+	void submit(RenderCall_t call);
+
+	// Sends what is left and waits for the workers to draw it
+	void finish();
+
+	// Engine settings after every submitted call
+	const RenderEngine& settings() const;
+
+private:
+	using Batch_t = std::shared_ptr<const std::vector<RenderCall_t>>;
+
+	struct Worker
+	{
+		Worker(const RenderEngine& renderEngine, const Rect& band);
+
+		RenderEngine renderEngine;
+		ClippedDrawable surface;
+		SpscQueue<Batch_t> queue;
+		std::thread thread;
+	};
+
+	void flush();
+
+	static void work(Worker& worker);
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::vector<RenderCall_t> pending;
+};
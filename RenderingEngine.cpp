@@ -9,13 +9,14 @@
 
 RenderEngine::RenderEngine(const Rect& viewPort, Drawable* drawSurface, const Color& maxColor) :
 	_viewPort(viewPort),
+	rasterBand(viewPort),
 	_drawSurface(drawSurface),
 	redLerp(0, 200, std::get<0>(maxColor.getColorChannels()), 0),
 	greenLerp(0, 200, std::get<1>(maxColor.getColorChannels()), 0),
 	blueLerp(0, 200, std::get<2>(maxColor.getColorChannels()), 0),
 	ambientColor(maxColor)
 {
-	zBuffer = Matrix2D<double>(_viewPort.width, std::vector<double>(_viewPort.height, zThreshold));
+	zBuffer = Matrix2D<double>(rasterBand.width, std::vector<double>(rasterBand.height, zThreshold));
 
 	auto viewPlaneWidth = 200.0;
 	auto viewPlaneHeight = 200.0;
@@ -32,9 +33,11 @@ RenderEngine::RenderEngine(const Rect& viewPort, Drawable* drawSurface, const Co
 
 	viewPortTransformationMatrix = viewPortTransformationMatrix * translationMatrix;
 	viewPortTransformationMatrix = viewPortTransformationMatrix * scaleMatrix;
+
+	SetSpecularExponent(p);
 }
 
-Point getFaceNormal(Polygon_t &cameraVertices)
+Point getFaceNormal(const ArenaVector<Point4D>& cameraVertices)
 {
 	Plane_t face = { cameraVertices[0], cameraVertices[1], cameraVertices[2] };
 	auto normal4D = normalize(getNormal(face));
@@ -49,198 +52,276 @@ void RenderEngine::RenderTriangle(const Polygon_t& triangle, RenderMode renderMo
 		// Clip to near (far)
 		
 		// Translate to screen space
-		//auto cameraVertices = sortVertices(triangle);
-		auto cameraVertices = triangle;
-		std::vector<Point4D> vertices;
-		vertices.resize(cameraVertices.size());
-		std::transform(cameraVertices.begin(), cameraVertices.end(), vertices.begin(), [this](auto& p)
-		{
-			auto v = perspectiveTransformationMatrix * p.getVector();
-			v = v / v[3];
+		Arena::Scope transientScope(frameArena);
 
-			v = viewPortTransformationMatrix * v;
+		//auto cameraVertices = sortVertices(triangle);
+		ArenaVector<Point4D> cameraVertices(triangle.begin(), triangle.end(), frameArena);
+		ArenaVector<Point4D> vertices(cameraVertices.size(), frameArena);
+		std::transform(cameraVertices.begin(), cameraVertices.end(), vertices.begin(), [this](auto& p) { return ProjectVertex(p); });
 
-			if (p.normal.has_value())
-			{
-				return Point4D{ v[0], v[1], v[2], v[3], p.color, p.normal.value() };
-			}
-			else
-			{
-				return Point4D{ v[0], v[1], v[2], v[3], p.color };
-			}
-		});
-		
-		std::vector<Point4D> points;
+		ShadeTriangle(cameraVertices, vertices, renderMode);
+	}
+}
 
-		auto faceNormal = getFaceNormal(cameraVertices);
-		auto centerPoint = getCenterPoint(cameraVertices);
-		if (dot(normalize(centerPoint), faceNormal) > 0)
-			return;
+void RenderEngine::RenderTriangles(const TriangleBatch& batch, RenderMode renderMode)
+{
+	// Each vertex is projected once however many triangles use it, the
+	// buffer is reused between batches so its storage only grows
+	batchVertices.resize(batch.vertices.size());
+	std::transform(batch.vertices.begin(), batch.vertices.end(), batchVertices.begin(), [this](auto& p) { return ProjectVertex(p); });
 
-		// Flat
-		if (currentLightingMethod == LightingMethod::Flat)
+	for (auto& triangle : batch.triangles)
+	{
+		if (std::all_of(triangle.begin(), triangle.end(), [this, &batch](auto i) {return batch.vertices[i].z >= _camera.near; }))
 		{
-			Point normal;
-			// If any vertice has no normal
-			if (std::any_of(vertices.begin(), vertices.end(), [](auto p) { return !p.normal.has_value(); }))
-			{
-				// Calculate face normal
-				normal = getFaceNormal(cameraVertices);
-			}
-			// Average normal
-			else
-			{
-				auto normal4D = normalize((cameraVertices[0].normal.value() + cameraVertices[1].normal.value() + cameraVertices[2].normal.value()) / 3);
-				normal = Point{ normal4D.x, normal4D.y, normal4D.z };
-			}
+			Arena::Scope transientScope(frameArena);
 
-			// Lighting at center
-			centerPoint.normal = normal;
-			auto color = PointLighter::calculateLights(centerPoint, lights, ks, p);
-			for (auto& v : vertices)
+			ArenaVector<Point4D> cameraVertices(frameArena);
+			ArenaVector<Point4D> vertices(frameArena);
+			cameraVertices.reserve(triangle.size());
+			vertices.reserve(triangle.size());
+			for (auto i : triangle)
 			{
-				v.color = v.color * ambientColor + color;
+				cameraVertices.push_back(batch.vertices[i]);
+				vertices.push_back(batchVertices[i]);
 			}
 
-			// Raster
-			if (renderMode == RenderMode::Filled)
-			{
-				points = std::move(PointGenerator::generatePolygonPoints(vertices));
-			}
-			else
-			{
-				points = std::move(PointGenerator::generateWireframePoints(vertices));
-			}
+			ShadeTriangle(cameraVertices, vertices, renderMode);
 		}
-		// Gouraud
-		else if (currentLightingMethod == LightingMethod::Gouraud)
-		{
-			// If any vertice has no normal
-			if (std::any_of(vertices.begin(), vertices.end(), [](auto p) { return !p.normal.has_value(); }))
-			{
-				// Calculate face normal
-				auto normal = getFaceNormal(cameraVertices);
-				// Set normal for each vertex
-				for (auto& v : vertices)
-				{
-					v.normal.emplace(std::move(normal));
-				}
-			}
+	}
+}
 
-			// calculate light at each vertex
-			for (auto index = 0u; index < vertices.size(); ++index)
-			{
-				auto cameraVertex = cameraVertices[index];
-				cameraVertex.normal.emplace(vertices[index].normal.value());
-				vertices[index].color = vertices[index].color * ambientColor + PointLighter::calculateLights(cameraVertex, lights, ks, p);
-			}
+Point4D RenderEngine::ProjectVertex(const Point4D& p) const
+{
+	auto v = perspectiveTransformationMatrix * p.getVector();
+	v = v / v[3];
 
-			//for (auto& v : vertices)
-			//{
-			//	v.color = v.color * ambientColor + PointLighter::calculateLights(v, lights, ks, p);
-			//}
+	v = viewPortTransformationMatrix * v;
 
-			// Raster
-			if (renderMode == RenderMode::Filled)
-			{
-				points = std::move(PointGenerator::generatePolygonPoints(vertices));
-			}
-			else
-			{
-				points = std::move(PointGenerator::generateWireframePoints(vertices));
-			}
+	if (p.normal.has_value())
+	{
+		return Point4D{ v[0], v[1], v[2], v[3], p.color, p.normal.value() };
+	}
+	else
+	{
+		return Point4D{ v[0], v[1], v[2], v[3], p.color };
+	}
+}
 
+void RenderEngine::ShadeTriangle(const ArenaVector<Point4D>& cameraVertices, ArenaVector<Point4D>& vertices, RenderMode renderMode)
+{
+	if (!RecordBounds(vertices))
+		return;
+	
+	auto faceNormal = getFaceNormal(cameraVertices);
+	auto centerPoint = getCenterPoint(cameraVertices);
+	if (dot(normalize(centerPoint), faceNormal) > 0)
+		return;
+
+	// Only the lights that can reach this triangle are evaluated per point
+	ArenaVector<Light> triangleLights(frameArena);
+	PointLighter::cullLights(lights, ks, cameraVertices, triangleLights);
+
+	ArenaVector<Point4D> points(frameArena);
+	ArenaVector<SampleCoverage> coverage(frameArena);
+
+	// Flat
+	if (currentLightingMethod == LightingMethod::Flat)
+	{
+		Point normal;
+		// If any vertice has no normal
+		if (std::any_of(vertices.begin(), vertices.end(), [](auto p) { return !p.normal.has_value(); }))
+		{
+			// Calculate face normal
+			normal = getFaceNormal(cameraVertices);
 		}
-		// Phong
+		// Average normal
 		else
 		{
-			// If any vertice has no normal
-			if (std::any_of(vertices.begin(), vertices.end(), [](auto p) { return !p.normal.has_value(); }))
-			{
-				// Calculate face normal
-				auto normal = getFaceNormal(cameraVertices);
-				// Set normal for each vertex
-				for (auto& v : vertices)
-				{
-					v.normal.emplace(std::move(normal));
-				}
-			}
+			auto normal4D = normalize((cameraVertices[0].normal.value() + cameraVertices[1].normal.value() + cameraVertices[2].normal.value()) / 3);
+			normal = Point{ normal4D.x, normal4D.y, normal4D.z };
+		}
 
-			// Save camera space points
-			/*for (auto& v : vertices)
-			{
-				v.cameraSpacePoint.emplace( v.x, v.y, v.z );
-			}*/
+		// Lighting at center
+		centerPoint.normal = normal;
+		auto color = PointLighter::calculateLights(centerPoint, triangleLights, ks, *specularTable);
+		for (auto& v : vertices)
+		{
+			v.color = v.color * ambientColor + color;
+		}
 
-			for (auto index = 0u; index < vertices.size(); ++index)
+		// Raster
+		if (renderMode == RenderMode::Filled)
+		{
+			RasterizePolygon(vertices, points, coverage);
+		}
+		else
+		{
+			PointGenerator::generateWireframePoints(vertices, rasterBand, points);
+		}
+	}
+	// Gouraud
+	else if (currentLightingMethod == LightingMethod::Gouraud)
+	{
+		// If any vertice has no normal
+		if (std::any_of(vertices.begin(), vertices.end(), [](auto p) { return !p.normal.has_value(); }))
+		{
+			// Calculate face normal
+			auto normal = getFaceNormal(cameraVertices);
+			// Set normal for each vertex
+			for (auto& v : vertices)
 			{
-				auto cameraVertex = cameraVertices[index];
-				vertices[index].cameraSpacePoint.emplace(cameraVertex.x, cameraVertex.y, cameraVertex.x);
+				v.normal.emplace(std::move(normal));
 			}
+		}
 
-			if (renderMode == RenderMode::Filled)
-			{
-				points = std::move(PointGenerator::generatePolygonPoints(vertices));
-			}
-			else
-			{
-				points = std::move(PointGenerator::generateWireframePoints(vertices));
-			}
+		// calculate light at each vertex
+		for (auto index = 0u; index < vertices.size(); ++index)
+		{
+			auto cameraVertex = cameraVertices[index];
+			cameraVertex.normal.emplace(vertices[index].normal.value());
+			vertices[index].color = vertices[index].color * ambientColor + PointLighter::calculateLights(cameraVertex, triangleLights, ks, *specularTable);
+		}
 
-			// calculate light at each vertex
-			for (auto& v : points)
+		//for (auto& v : vertices)
+		//{
+		//	v.color = v.color * ambientColor + PointLighter::calculateLights(v, lights, ks, p);
+		//}
+
+		// Raster
+		if (renderMode == RenderMode::Filled)
+		{
+			RasterizePolygon(vertices, points, coverage);
+		}
+		else
+		{
+			PointGenerator::generateWireframePoints(vertices, rasterBand, points);
+		}
+
+	}
+	// Phong
+	else
+	{
+		// If any vertice has no normal
+		if (std::any_of(vertices.begin(), vertices.end(), [](auto p) { return !p.normal.has_value(); }))
+		{
+			// Calculate face normal
+			auto normal = getFaceNormal(cameraVertices);
+			// Set normal for each vertex
+			for (auto& v : vertices)
 			{
-				auto cameraPoint = Point4D(v.cameraSpacePoint.value());
-				cameraPoint.normal = v.normal;
-				v.color = v.color * ambientColor + PointLighter::calculateLights(cameraPoint, lights, ks, p);
+				v.normal.emplace(std::move(normal));
 			}
 		}
 
+		// Save camera space points
+		/*for (auto& v : vertices)
+		{
+			v.cameraSpacePoint.emplace( v.x, v.y, v.z );
+		}*/
+
+		for (auto index = 0u; index < vertices.size(); ++index)
+		{
+			auto cameraVertex = cameraVertices[index];
+			vertices[index].cameraSpacePoint.emplace(cameraVertex.x, cameraVertex.y, cameraVertex.x);
+		}
+
+		// The shaded points are not the camera vertices here, bound them instead
+		ArenaVector<Point4D> shadedVertices(frameArena);
+		shadedVertices.reserve(vertices.size());
+		for (auto& v : vertices)
+		{
+			shadedVertices.push_back(Point4D(v.cameraSpacePoint.value()));
+		}
+		triangleLights.clear();
+		PointLighter::cullLights(lights, ks, shadedVertices, triangleLights);
 
-		if (depthSet)
+		if (renderMode == RenderMode::Filled)
+		{
+			RasterizePolygon(vertices, points, coverage);
+		}
+		else
 		{
-			PointLighter::calculateDepthShading(points, _depth);
+			PointGenerator::generateWireframePoints(vertices, rasterBand, points);
 		}
 
-		PointsRenderer::renderPoints(points, _drawSurface, zBuffer, _viewPort, _camera);
+		// calculate light at each vertex
+		PointLighter::calculatePhongLighting(points, ambientColor, triangleLights, ks, *specularTable);
 	}
+
+
+	RenderPoints(points, coverage);
 }
 
-void RenderEngine::RenderFace(const Face& face, RenderMode renderMode)
+void RenderEngine::RenderMesh(const Mesh& mesh, const CTM_t& modelViewMatrix, RenderMode renderMode)
+{
+	// Normals go through the inverse transpose so they stay perpendicular under non-uniform scale
+	auto normalMatrix = transpose(invert(modelViewMatrix));
+	auto transformNormal = [&normalMatrix](const auto& n)
+	{
+		return normalize(normalMatrix * Point4D{ n.x, n.y, n.z, 0.0 });
+	};
+
+	// Bring the instance into camera space, the buffers are reused between
+	// instances so their storage only grows
+	instancePositions.resize(mesh.vertices.size());
+	std::transform(mesh.vertices.begin(), mesh.vertices.end(), instancePositions.begin(), [&modelViewMatrix](auto& v) { return modelViewMatrix * v.location; });
+
+	instanceNormals.resize(mesh.normals.size());
+	std::transform(mesh.normals.begin(), mesh.normals.end(), instanceNormals.begin(), [&transformNormal](auto& n)
+	{
+		auto normal = transformNormal(n);
+		return Point{ normal.x, normal.y, normal.z };
+	});
+
+	// Faces that share an edge only draw it once in wireframe
+	if (renderMode == RenderMode::Wireframe)
+	{
+		drawnEdges.assign(mesh.edges.size(), false);
+	}
+
+	for (auto& f : mesh.faces)
+	{
+		RenderFace(f, transformNormal(f.normal), instancePositions, instanceNormals, renderMode);
+	}
+}
+
+void RenderEngine::RenderFace(const Face& face, const Point4D& faceNormal, const std::vector<Point4D>& positions, const std::vector<Point>& normals, RenderMode renderMode)
 {
 	// Basic culling
-	if (std::all_of(face.vertices.begin(), face.vertices.end(), [this](auto& p) {return p->location.z >= _camera.near && p->location.z <= _camera.far; }))
+	if (std::all_of(face.vertexIndices.begin(), face.vertexIndices.end(), [this, &positions](auto i) {return positions[i].z >= _camera.near && positions[i].z <= _camera.far; }))
 	{
+		Arena::Scope transientScope(frameArena);
+
 		// If center point dot face normal positive, cull
-		std::vector<Point4D> cameraVertices;
-		cameraVertices.resize(face.vertices.size());
-		std::transform(face.vertices.begin(), face.vertices.end(), cameraVertices.begin(), [](auto& v) {return v->location; });
+		ArenaVector<Point4D> cameraVertices(face.vertexIndices.size(), frameArena);
+		std::transform(face.vertexIndices.begin(), face.vertexIndices.end(), cameraVertices.begin(), [&positions](auto i) {return positions[i]; });
 		
 		auto centerPoint = getCenterPoint(cameraVertices);
-		if (dot(normalize(centerPoint), face.normal) > 0)
+		if (dot(normalize(centerPoint), faceNormal) > 0)
 			return;
 
 		// Generate projected points
-		std::vector<Point4D> projectedVertices;
-		projectedVertices.resize(face.vertices.size());
-		std::transform(face.vertices.begin(), face.vertices.end(), projectedVertices.begin(), [this](auto& p)
+		ArenaVector<Point4D> projectedVertices(face.vertexIndices.size(), frameArena);
+		std::transform(cameraVertices.begin(), cameraVertices.end(), projectedVertices.begin(), [this](auto& p)
 		{
-			auto v = perspectiveTransformationMatrix * p->location.getVector();
+			auto v = perspectiveTransformationMatrix * p.getVector();
 			v = v / v[3];
 
 			v = viewPortTransformationMatrix * v;
 
-			if (p->assignedNormal.has_value())
-			{
-				return Point4D{ v[0], v[1], v[2], v[3], p->location.color, p->assignedNormal.value() };
-			}
-			else
-			{
-				return Point4D{ v[0], v[1], v[2], v[3], p->location.color };
-			}
+			return Point4D{ v[0], v[1], v[2], v[3], p.color };
 		});
+
+		if (!RecordBounds(projectedVertices))
+			return;
 		
-		std::vector<Point4D> points;
+		// Only the lights that can reach this face are evaluated per point
+		ArenaVector<Light> faceLights(frameArena);
+		PointLighter::cullLights(lights, ks, cameraVertices, faceLights);
+
+		ArenaVector<Point4D> points(frameArena);
+		ArenaVector<SampleCoverage> coverage(frameArena);
 
 		switch (currentLightingMethod)
 		{
@@ -249,19 +330,19 @@ void RenderEngine::RenderFace(const Face& face, RenderMode renderMode)
 			{
 				//		If no assigned normal, use face normal
 				Point normal;
-				if (std::any_of(face.vertices.begin(), face.vertices.end(), [](auto& v) {return !v->assignedNormal.has_value(); }))
+				if (!face.hasAssignedNormals)
 				{
-					normal = Point{ face.normal.x, face.normal.y, face.normal.z };
+					normal = Point{ faceNormal.x, faceNormal.y, faceNormal.z };
 				}
 				// Otherwise average assigned normals
 				else
 				{
-					auto normal4D = normalize((face.vertices[0]->assignedNormal.value() + face.vertices[1]->assignedNormal.value() + face.vertices[2]->assignedNormal.value()) / 3);
+					auto normal4D = normalize((Point4D{ normals[face.normalIndices[0]] } + Point4D{ normals[face.normalIndices[1]] } + Point4D{ normals[face.normalIndices[2]] }) / 3);
 					normal = Point{ normal4D.x, normal4D.y, normal4D.z };
 				}
 				// Assign face normal to center point, calculate lighting
 				centerPoint.normal = (normal);
-				auto color = PointLighter::calculateLights(centerPoint, lights, ks, p);
+				auto color = PointLighter::calculateLights(centerPoint, faceLights, ks, *specularTable);
 
 				// Assign lighting to vertices
 				for (auto& v : projectedVertices)
@@ -272,11 +353,11 @@ void RenderEngine::RenderFace(const Face& face, RenderMode renderMode)
 				// Rasterize
 				if (renderMode == RenderMode::Filled)
 				{
-					points = std::move(PointGenerator::generatePolygonPoints(projectedVertices));
+					RasterizePolygon(projectedVertices, points, coverage);
 				}
 				else
 				{
-					points = std::move(PointGenerator::generateWireframePoints(projectedVertices));
+					RenderEdges(face, projectedVertices);
 				}
 			} break;
 
@@ -284,24 +365,10 @@ void RenderEngine::RenderFace(const Face& face, RenderMode renderMode)
 			case LightingMethod::Gouraud:
 			case LightingMethod::Phong:
 			{
-				// If no assigned normal, average the face normals at vertex
-				if (std::any_of(face.vertices.begin(), face.vertices.end(), [](auto& v) {return !v->assignedNormal.has_value(); }))
-				{
-					for (auto i = 0u; i < face.vertices.size(); ++i)
-					{
-						auto normal = std::accumulate(face.vertices[i]->faceNormals.begin(), face.vertices[i]->faceNormals.end(), Point4D{ 0.0, 0.0, 0.0, 1.0 });
-						//normal = normal / static_cast<double>(face.vertices.size());
-						normal = normalize(normal);
-						cameraVertices[i].normal = Point{ normal.x, normal.y, normal.z };
-					}
-				}
-				// otherwise take the assigned normal
-				else
+				// Smoothed or assigned normals were resolved when the mesh was built
+				for (auto i = 0u; i < face.normalIndices.size(); ++i)
 				{
-					for (auto i = 0u; i < face.vertices.size(); ++i)
-					{
-						cameraVertices[i].normal = face.vertices[i]->assignedNormal.value();
-					}
+					cameraVertices[i].normal = normals[face.normalIndices[i]];
 				}
 
 				// If Gouraud
@@ -310,17 +377,17 @@ void RenderEngine::RenderFace(const Face& face, RenderMode renderMode)
 					// 	Calculate lighting at each vertex
 					for (auto i = 0u; i < cameraVertices.size(); ++i)
 					{
-						auto color = PointLighter::calculateLights(cameraVertices[i], lights, ks, p);
+						auto color = PointLighter::calculateLights(cameraVertices[i], faceLights, ks, *specularTable);
 						projectedVertices[i].color = color;
 					}
 					// Rasterize
 					if (renderMode == RenderMode::Filled)
 					{
-						points = std::move(PointGenerator::generatePolygonPoints(projectedVertices));
+						RasterizePolygon(projectedVertices, points, coverage);
 					}
 					else
 					{
-						points = std::move(PointGenerator::generateWireframePoints(projectedVertices));
+						RenderEdges(face, projectedVertices);
 					}
 				}
 
@@ -338,28 +405,20 @@ void RenderEngine::RenderFace(const Face& face, RenderMode renderMode)
 					// 	Rasterize
 					if (renderMode == RenderMode::Filled)
 					{
-						points = std::move(PointGenerator::generatePolygonPoints(projectedVertices));
+						RasterizePolygon(projectedVertices, points, coverage);
 						
 						// 	Calculate lighting at each rasterized points
-						for (auto& v : points)
-						{
-							if (v.normal.has_value())
-							{
-								auto cameraPoint = Point4D(v.cameraSpacePoint.value());
-								cameraPoint.normal = v.normal;
-								v.color = v.color * ambientColor + PointLighter::calculateLights(cameraPoint, lights, ks, p);
-							}
-						}
+						PointLighter::calculatePhongLighting(points, ambientColor, faceLights, ks, *specularTable);
 					}
 					else
 					{
 						// 	Calculate lighting at each vertex
 						for (auto i = 0u; i < cameraVertices.size(); ++i)
 						{
-							auto color = PointLighter::calculateLights(cameraVertices[i], lights, ks, p);
+							auto color = PointLighter::calculateLights(cameraVertices[i], faceLights, ks, *specularTable);
 							projectedVertices[i].color = color;
 						}
-						points = std::move(PointGenerator::generateWireframePoints(projectedVertices));
+						RenderEdges(face, projectedVertices);
 					}
 					
 				}
@@ -367,46 +426,140 @@ void RenderEngine::RenderFace(const Face& face, RenderMode renderMode)
 			} break;
 		}
 
-		if (depthSet)
+		RenderPoints(points, coverage);
+	}
+}
+
+void RenderEngine::RenderEdges(const Face& face, const ArenaVector<Point4D>& projectedVertices)
+{
+	for (auto i = 0u; i < face.edgeIndices.size(); ++i)
+	{
+		auto edge = face.edgeIndices[i];
+		if (drawnEdges[edge])
 		{
-			PointLighter::calculateDepthShading(points, _depth);
+			continue;
 		}
+		drawnEdges[edge] = true;
 
-		PointsRenderer::renderPoints(points, _drawSurface, zBuffer, _viewPort, _camera);
+		auto j = (i + 1) % projectedVertices.size();
+		if (lineMode == LineMode::Antialiased)
+		{
+			PointsRenderer::renderAntialiasedLine(projectedVertices[i], projectedVertices[j], _drawSurface, zBuffer, rasterBand, _camera, depthCue);
+		}
+		else
+		{
+			PointsRenderer::renderLine(projectedVertices[i], projectedVertices[j], _drawSurface, zBuffer, rasterBand, _camera, depthCue);
+		}
+	}
+}
+
+void RenderEngine::RasterizePolygon(const ArenaVector<Point4D>& vertices, ArenaVector<Point4D>& points, ArenaVector<SampleCoverage>& coverage)
+{
+	if (multisampleBuffer.has_value())
+	{
+		PointGenerator::generatePolygonSamples(vertices, rasterBand, multisampleBuffer->offsets(), points, coverage);
+	}
+	else
+	{
+		PointGenerator::generatePolygonPoints(vertices, rasterBand, points);
+	}
+}
+
+void RenderEngine::RenderPoints(const ArenaVector<Point4D>& points, const ArenaVector<SampleCoverage>& coverage)
+{
+	if (multisampleBuffer.has_value())
+	{
+		PointsRenderer::renderSamples(points, coverage, _drawSurface, zBuffer, *multisampleBuffer, rasterBand, _camera, depthCue);
+	}
+	else
+	{
+		PointsRenderer::renderPoints(points, _drawSurface, zBuffer, rasterBand, _camera, depthCue);
 	}
 }
 
 void RenderEngine::RenderLine(const Line_t& line)
 {
-	std::vector<Point> vertices;
-	vertices.resize(line.size());
-	std::transform(line.begin(), line.end(), vertices.begin(), [this](auto& p)
+	auto start = line[0];
+	auto end = line[1];
+	if (ClipLineToNear(start, end))
+	{
+		DrawLine({ ProjectLineVertex(start), ProjectLineVertex(end) });
+	}
+}
+
+void RenderEngine::RenderLines(const LineBatch& batch)
+{
+	// Endpoints shared by several lines are projected once, the ones behind
+	// the near plane are never used as they are
+	batchLineVertices.resize(batch.vertices.size());
+	std::transform(batch.vertices.begin(), batch.vertices.end(), batchLineVertices.begin(), [this](auto& p)
 	{
-		auto v = perspectiveTransformationMatrix * p.getVector();
-		v = viewPortTransformationMatrix * v;
-		// HACK		
-		if (v[3] != 0)
+		return p.z >= _camera.near ? ProjectLineVertex(p) : Point{};
+	});
+
+	for (auto& line : batch.lines)
+	{
+		auto& start = batch.vertices[line[0]];
+		auto& end = batch.vertices[line[1]];
+		if (start.z >= _camera.near && end.z >= _camera.near)
 		{
-			v = v / v[3];
+			DrawLine({ batchLineVertices[line[0]], batchLineVertices[line[1]] });
 		}
 		else
 		{
-			v = v / _camera.near;
+			RenderLine(Line_t{ start, end });
 		}
+	}
+}
 
-		return Point{ v[0], v[1], v[2], &this->_viewPort, p.color };
-	});
+bool RenderEngine::ClipLineToNear(Point4D& start, Point4D& end) const
+{
+	auto startInFront = start.z >= _camera.near;
+	auto endInFront = end.z >= _camera.near;
+	if (startInFront == endInFront)
+	{
+		return startInFront;
+	}
+
+	auto& inFront = startInFront ? start : end;
+	auto& behind = startInFront ? end : start;
+	auto t = (_camera.near - inFront.z) / (behind.z - inFront.z);
+	behind = Point4D{ inFront.x + t * (behind.x - inFront.x), inFront.y + t * (behind.y - inFront.y), _camera.near, 1.0,
+					  inFront.color * (1.0 - t) + behind.color * t };
+	return true;
+}
 
-	auto points = std::move(PointGenerator::generateLinePoints(vertices[0], vertices[1]));
-	points.erase(std::remove_if(points.begin(), points.end(), [this](auto& p) { return  p.z > this->_camera.far || p.z < this->_camera.near; }), points.end());
-	PointLighter::calculateAmbientLight(points, ambientColor);
+Point RenderEngine::ProjectLineVertex(const Point4D& p) const
+{
+	auto v = perspectiveTransformationMatrix * p.getVector();
+	v = viewPortTransformationMatrix * v;
+	v = v / v[3];
+
+	return Point{ v[0], v[1], v[2], &this->_viewPort, p.color.toColor() };
+}
 
-	if (depthSet)
+void RenderEngine::DrawLine(const std::array<Point, 2>& vertices)
+{
+	if (!RecordBounds(vertices))
 	{
-		PointLighter::calculateDepthShading(points, _depth);
+		return;
 	}
 
-	PointsRenderer::renderPoints(points, _drawSurface, zBuffer, _viewPort, _camera);
+	// Lit by ambient at the ends, the walk interpolates the lit colour. Both
+	// walks only step where the line crosses the raster band
+	auto ambient = FloatColor{ ambientColor };
+	auto start = Point4D{ vertices[0] };
+	auto end = Point4D{ vertices[1] };
+	start.color = start.color * ambient;
+	end.color = end.color * ambient;
+	if (lineMode == LineMode::Antialiased)
+	{
+		PointsRenderer::renderAntialiasedLine(start, end, _drawSurface, zBuffer, rasterBand, _camera, depthCue);
+	}
+	else
+	{
+		PointsRenderer::renderLine(start, end, _drawSurface, zBuffer, rasterBand, _camera, depthCue);
+	}
 }
 
 void RenderEngine::SetAmbientColor(const Color& color)
@@ -438,6 +591,13 @@ void RenderEngine::SetCamera(const Camera& camera)
 	viewPortTransformationMatrix = viewPortTransformationMatrix * translationMatrix;
 	viewPortTransformationMatrix = viewPortTransformationMatrix * scaleMatrix;
 
+	nearPlane = { Point4D{ _camera.xLow, _camera.yLow, _camera.near, 1.0 },
+				  Point4D{ _camera.xHigh, _camera.yLow, _camera.near, 1.0 },
+				  Point4D{ _camera.xHigh, _camera.yHigh, _camera.near, 1.0 } };
+}
+
+void RenderEngine::ClearDepthBuffer()
+{
 	for (auto& r : zBuffer)
 	{
 		for (auto& e : r)
@@ -446,15 +606,152 @@ void RenderEngine::SetCamera(const Camera& camera)
 		}
 	}
 
-	nearPlane = { Point4D{ _camera.xLow, _camera.yLow, _camera.near, 1.0 },
-				  Point4D{ _camera.xHigh, _camera.yLow, _camera.near, 1.0 },
-				  Point4D{ _camera.xHigh, _camera.yHigh, _camera.near, 1.0 } };
+	if (multisampleBuffer.has_value())
+	{
+		multisampleBuffer.emplace(rasterBand.width, rasterBand.height, multisampleBuffer->sampleCount());
+	}
+}
+
+void RenderEngine::ClearRegion(const Rect& region, unsigned int color)
+{
+	auto cleared = intersect(region, rasterBand);
+	if (!cleared.has_value())
+	{
+		return;
+	}
+
+	auto farZ = static_cast<int>(std::round(_camera.far + 1));
+	for (auto x = cleared->x; x < cleared->right(); ++x)
+	{
+		for (auto y = cleared->y; y < cleared->bottom(); ++y)
+		{
+			zBuffer[x - rasterBand.x][y - rasterBand.y] = farZ;
+			if (multisampleBuffer.has_value())
+			{
+				multisampleBuffer->clear(x - rasterBand.x, y - rasterBand.y);
+			}
+			_drawSurface->setPixel(x, y, color);
+		}
+	}
+}
+
+void RenderEngine::SetClipRegion(const std::optional<Rect>& region)
+{
+	clipRegion = region;
+}
+
+void RenderEngine::SetRasterBand(const Rect& band)
+{
+	auto kept = intersect(band, rasterBand);
+	if (!kept.has_value())
+	{
+		throw std::invalid_argument("The raster band has to lie inside the viewport");
+	}
+
+	auto depth = Matrix2D<double>(kept->width, std::vector<double>(kept->height));
+	for (auto x = 0; x < kept->width; ++x)
+	{
+		auto& column = zBuffer[kept->x - rasterBand.x + x];
+		std::copy(column.begin() + (kept->y - rasterBand.y), column.begin() + (kept->y - rasterBand.y + kept->height), depth[x].begin());
+	}
+	zBuffer = std::move(depth);
+	rasterBand = *kept;
+
+	// Untouched samples are seeded from the surface again
+	if (multisampleBuffer.has_value())
+	{
+		multisampleBuffer.emplace(rasterBand.width, rasterBand.height, multisampleBuffer->sampleCount());
+	}
+}
+
+bool RenderEngine::BoxInView(const std::array<Vector4_t, 8>& corners) const
+{
+	// The viewport transform only scales and offsets x / z and y / z, so each
+	// viewport edge is a plane through the eye. A couple of pixels of slack
+	// cover rounding and anti-aliased fringes
+	auto slack = 2.0;
+	auto scale = viewPortTransformationMatrix * Vector4_t{ 1.0, 1.0, 0.0, 0.0 };
+	auto offset = viewPortTransformationMatrix * Vector4_t{ 0.0, 0.0, 0.0, 1.0 };
+	std::array<Vector4_t, 5> planes{ { { scale[0], 0.0, offset[0] - (_viewPort.x - slack), 0.0 },
+									   { -scale[0], 0.0, _viewPort.right() + slack - offset[0], 0.0 },
+									   { 0.0, scale[1], offset[1] - (_viewPort.y - slack), 0.0 },
+									   { 0.0, -scale[1], _viewPort.bottom() + slack - offset[1], 0.0 },
+									   { 0.0, 0.0, 1.0, -_camera.near } } };
+
+	return std::none_of(planes.begin(), planes.end(), [&corners](const Vector4_t& plane)
+	{
+		return std::all_of(corners.begin(), corners.end(), [&plane](const Vector4_t& c)
+		{
+			return plane[0] * c[0] + plane[1] * c[1] + plane[2] * c[2] + plane[3] < 0.0;
+		});
+	});
+}
+
+std::optional<Rect> RenderEngine::TakeDrawnBounds()
+{
+	auto bounds = drawnBounds;
+	drawnBounds.reset();
+	return bounds;
+}
+
+void RenderEngine::SetDrawSurface(Drawable* drawSurface)
+{
+	_drawSurface = drawSurface;
+}
+
+Drawable* RenderEngine::GetDrawSurface() const
+{
+	return _drawSurface;
+}
+
+const Rect& RenderEngine::GetViewPort() const
+{
+	return _viewPort;
+}
+
+void RenderEngine::RestoreSettings(const RenderEngine& settings)
+{
+	ambientColor = settings.ambientColor;
+	_camera = settings._camera;
+	depthCue = settings.depthCue;
+	clipRegion = settings.clipRegion;
+	viewPortTransformationMatrix = settings.viewPortTransformationMatrix;
+	perspectiveTransformationMatrix = settings.perspectiveTransformationMatrix;
+	lights = settings.lights;
+	currentLightingMethod = settings.currentLightingMethod;
+	lineMode = settings.lineMode;
+	nearPlane = settings.nearPlane;
+	ks = settings.ks;
+	p = settings.p;
+	specularTables = settings.specularTables;
+	specularTable = settings.specularTable;
+
+	// Only the sample count, the samples themselves stay sized to this band
+	SetMultisampling(settings.multisampleBuffer.has_value() ? settings.multisampleBuffer->sampleCount() : 1);
+}
+
+template <typename T>
+bool RenderEngine::RecordBounds(const T& projectedVertices)
+{
+	auto [minX, maxX] = std::minmax_element(projectedVertices.begin(), projectedVertices.end(), [](const auto& a, const auto& b) { return a.x < b.x; });
+	auto [minY, maxY] = std::minmax_element(projectedVertices.begin(), projectedVertices.end(), [](const auto& a, const auto& b) { return a.y < b.y; });
+
+	// One pixel of slack for rounding and anti-aliased fringes
+	auto left = static_cast<int>(std::floor(minX->x)) - 1;
+	auto top = static_cast<int>(std::floor(minY->y)) - 1;
+	auto box = intersect(Rect{ left, top, static_cast<int>(std::ceil(maxX->x)) + 2 - left, static_cast<int>(std::ceil(maxY->y)) + 2 - top }, _viewPort);
+	if (!box.has_value())
+	{
+		return false;
+	}
+
+	drawnBounds = drawnBounds.has_value() ? unite(*drawnBounds, *box) : *box;
+	return !clipRegion.has_value() || intersect(*box, *clipRegion).has_value();
 }
 
 void RenderEngine::SetDepth(const Depth& depth)
 {
-	depthSet = true;
-	_depth = depth;
+	depthCue.emplace(depth);
 }
 
 void RenderEngine::AddLight(const Light& light)
@@ -467,6 +764,28 @@ void RenderEngine::SetLightingMethod(const LightingMethod& lightingMethod)
 	currentLightingMethod = lightingMethod;
 }
 
+void RenderEngine::SetMultisampling(int sampleCount)
+{
+	if (multisampleBuffer.has_value() && multisampleBuffer->sampleCount() == sampleCount)
+	{
+		return;
+	}
+
+	if (sampleCount <= 1)
+	{
+		multisampleBuffer.reset();
+	}
+	else
+	{
+		multisampleBuffer.emplace(rasterBand.width, rasterBand.height, sampleCount);
+	}
+}
+
+void RenderEngine::SetLineMode(LineMode mode)
+{
+	lineMode = mode;
+}
+
 void RenderEngine::SetSpecularCoefficient(double value)
 {
 	ks = value;
@@ -475,4 +794,11 @@ void RenderEngine::SetSpecularCoefficient(double value)
 void RenderEngine::SetSpecularExponent(double value)
 {
 	p = value;
+
+	auto& table = specularTables[value];
+	if (!table)
+	{
+		table = std::make_shared<const SpecularTable>(value);
+	}
+	specularTable = table;
 }
@@ -1,6 +1,10 @@
 #pragma once
 #include <cmath>
+#include <memory>
+#include <optional>
+#include <unordered_map>
 
+#include "Arena.hpp"
 #include "Camera.hpp"
 #include "Color.hpp"
 #include "CommonTypeAliases.hpp"
@@ -9,8 +13,13 @@
 #include "lerp.hpp"
 #include "Light.hpp"
 #include "LineClipper.h"
+#include "MultisampleBuffer.hpp"
 #include "primitives.hpp"
+#include "SpecularTable.hpp"
 #include "Face.hpp"
+#include "Mesh.hpp"
+#include "LineBatch.hpp"
+#include "TriangleBatch.hpp"
 
 class RenderEngine
 {
@@ -23,27 +32,103 @@ public:
 		Wireframe
 	};
 
+	enum class LineMode
+	{
+		Aliased,
+		Antialiased
+	};
+
 	void RenderTriangle(const Polygon_t& triangle, RenderMode renderMode);
 
-	void RenderFace(const Face& triangle, RenderMode renderMode);
+	// The same as a RenderTriangle per triangle in order, but every vertex is
+	// projected once
+	void RenderTriangles(const TriangleBatch& batch, RenderMode renderMode);
+
+	void RenderMesh(const Mesh& mesh, const CTM_t& modelViewMatrix, RenderMode renderMode);
 
 	void RenderLine(const Line_t& line);
 
+	// The same as a RenderLine per line in order, but every endpoint is
+	// projected once
+	void RenderLines(const LineBatch& batch);
+
 	void SetAmbientColor(const Color& color);
 
 	void SetCamera(const Camera& camera);
 
+	void ClearDepthBuffer();
+
+	// Resets depth and paints color over region, so it can be drawn again
+	void ClearRegion(const Rect& region, unsigned int color);
+
+	// Primitives whose screen box misses the region are skipped
+	void SetClipRegion(const std::optional<Rect>& region);
+
+	// Draws only into band, a part of the viewport. The depth and sample
+	// buffers shrink to cover the band alone, keeping the depth already in it
+	void SetRasterBand(const Rect& band);
+
+	// False when a camera space box is entirely outside the view volume, that
+	// is behind the near plane or past one of the viewport edges
+	bool BoxInView(const std::array<Vector4_t, 8>& corners) const;
+
+	// Screen box of everything submitted since the last call
+	std::optional<Rect> TakeDrawnBounds();
+
+	void SetDrawSurface(Drawable* drawSurface);
+
+	Drawable* GetDrawSurface() const;
+
+	const Rect& GetViewPort() const;
+
 	void SetDepth(const Depth& depth);
 
 	void AddLight(const Light& light);
 
+	// Takes every setting from settings, the sample count included, but keeps the
+	// buffers, raster band and draw surface
+	void RestoreSettings(const RenderEngine& settings);
+
 	void SetLightingMethod(const LightingMethod& lightingMethod);
 
+	void SetLineMode(LineMode mode);
+
+	// 4 or 8 samples per pixel for filled polygons, 1 turns multisampling off
+	void SetMultisampling(int sampleCount);
+
 	void SetSpecularCoefficient(double value);
 	
 	void SetSpecularExponent(double value);
 
 private:
+	// Camera space to screen space, keeping color and normal
+	Point4D ProjectVertex(const Point4D& p) const;
+
+	// Lights and rasterizes a triangle that is in front of the near plane
+	void ShadeTriangle(const ArenaVector<Point4D>& cameraVertices, ArenaVector<Point4D>& vertices, RenderMode renderMode);
+
+	// Cuts a camera space line at the near plane, false when it is all behind it
+	bool ClipLineToNear(Point4D& start, Point4D& end) const;
+
+	// Camera space to screen space for lines clipped to the near plane
+	Point ProjectLineVertex(const Point4D& p) const;
+
+	void DrawLine(const std::array<Point, 2>& vertices);
+
+	void RenderFace(const Face& face, const Point4D& faceNormal, const std::vector<Point4D>& positions, const std::vector<Point>& normals, RenderMode renderMode);
+
+	void RenderEdges(const Face& face, const ArenaVector<Point4D>& projectedVertices);
+
+	// coverage is only filled when multisampling
+	void RasterizePolygon(const ArenaVector<Point4D>& vertices, ArenaVector<Point4D>& points, ArenaVector<SampleCoverage>& coverage);
+
+	void RenderPoints(const ArenaVector<Point4D>& points, const ArenaVector<SampleCoverage>& coverage);
+
+	// Grows the drawn bounds by the screen box of a primitive, false when the
+	// box misses the clip region
+	template <typename T>
+	bool RecordBounds(const T& projectedVertices);
+
 	Lerp<int> redLerp;
 	Lerp<int> greenLerp;
 	Lerp<int> blueLerp;
@@ -52,15 +137,18 @@ private:
 	double zThreshold = std::numeric_limits<double>::max();
 	
 	Rect _viewPort;
+	// Pixels the buffers cover and primitives are rasterized into
+	Rect rasterBand;
 	
 	Color ambientColor = Color(0, 0, 0);
 	
-	bool depthSet = false;
-
 	Drawable* _drawSurface;
 	
 	Camera _camera;
-	Depth _depth = Depth{ 0, std::numeric_limits<double>::max(), Color{0, 0, 0} };
+	std::optional<DepthCue> depthCue;
+	std::optional<MultisampleBuffer> multisampleBuffer;
+	std::optional<Rect> clipRegion;
+	std::optional<Rect> drawnBounds;
 	CTM_t viewPortTransformationMatrix = CTM_t { 1.0, 0.0, 0.0, 0.0,
 												 0.0, 1.0, 0.0, 0.0,
 												 0.0, 0.0, 1.0, 0.0,
@@ -74,10 +162,25 @@ private:
 
 	std::vector<Light> lights;
 	LightingMethod currentLightingMethod = LightingMethod::Flat;
+	LineMode lineMode = LineMode::Aliased;
 
 	Plane_t nearPlane;
 	//Plane_t farPlane;
 
 	double ks = .3;
 	double p = 8;
+
+	// Specular tables are kept per exponent, so switching between the
+	// surfaces of a scene never rebuilds one
+	std::unordered_map<double, std::shared_ptr<const SpecularTable>> specularTables;
+	std::shared_ptr<const SpecularTable> specularTable;
+
+	// Scratch storage for a single primitive, rewound after each one is drawn
+	Arena frameArena;
+	std::vector<Point4D> instancePositions;
+	std::vector<Point> instanceNormals;
+	std::vector<Point4D> batchVertices;
+	std::vector<Point> batchLineVertices;
+	// Edges of the current instance already drawn in wireframe
+	std::vector<bool> drawnEdges;
 };
@@ -0,0 +1,644 @@
+#include "SceneGraph.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stack>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "JobSystem.hpp"
+#include "Light.hpp"
+#include "MeshBuilder.hpp"
+
+namespace
+{
+	const CTM_t identity = CTM_t{ 1.0, 0.0, 0.0, 0.0,
+								  0.0, 1.0, 0.0, 0.0,
+								  0.0, 0.0, 1.0, 0.0,
+								  0.0, 0.0, 0.0, 1.0 };
+
+	template <typename Container>
+	Bounds boundsOf(const Container& points)
+	{
+		auto bounds = Bounds{ { points[0].x, points[0].y, points[0].z }, { points[0].x, points[0].y, points[0].z } };
+		for (auto& p : points)
+		{
+			bounds.min = { std::min(bounds.min[0], p.x), std::min(bounds.min[1], p.y), std::min(bounds.min[2], p.z) };
+			bounds.max = { std::max(bounds.max[0], p.x), std::max(bounds.max[1], p.y), std::max(bounds.max[2], p.z) };
+		}
+		return bounds;
+	}
+
+	Bounds boundsOf(const Mesh& mesh)
+	{
+		auto bounds = Bounds{ { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+		if (!mesh.vertices.empty())
+		{
+			auto& first = mesh.vertices.front().location;
+			bounds = Bounds{ { first.x, first.y, first.z }, { first.x, first.y, first.z } };
+		}
+		for (auto& v : mesh.vertices)
+		{
+			auto& p = v.location;
+			bounds.min = { std::min(bounds.min[0], p.x), std::min(bounds.min[1], p.y), std::min(bounds.min[2], p.z) };
+			bounds.max = { std::max(bounds.max[0], p.x), std::max(bounds.max[1], p.y), std::max(bounds.max[2], p.z) };
+		}
+		return bounds;
+	}
+
+	void merge(std::optional<Bounds>& into, const Bounds& other)
+	{
+		if (!into.has_value())
+		{
+			into = other;
+			return;
+		}
+
+		for (auto axis = 0; axis < 3; ++axis)
+		{
+			into->min[axis] = std::min(into->min[axis], other.min[axis]);
+			into->max[axis] = std::max(into->max[axis], other.max[axis]);
+		}
+	}
+
+	std::array<Vector4_t, 8> cornersOf(const Bounds& bounds, const CTM_t& matrix)
+	{
+		std::array<Vector4_t, 8> corners;
+		for (auto corner = 0; corner < 8; ++corner)
+		{
+			corners[corner] = matrix * Vector4_t{ corner & 1 ? bounds.max[0] : bounds.min[0],
+												  corner & 2 ? bounds.max[1] : bounds.min[1],
+												  corner & 4 ? bounds.max[2] : bounds.min[2],
+												  1.0 };
+		}
+		return corners;
+	}
+
+	// Box around the eight transformed corners
+	Bounds transformBounds(const Bounds& bounds, const CTM_t& matrix)
+	{
+		std::optional<Bounds> result;
+		for (auto& p : cornersOf(bounds, matrix))
+		{
+			merge(result, Bounds{ { p[0], p[1], p[2] }, { p[0], p[1], p[2] } });
+		}
+		return *result;
+	}
+
+	void applySetting(RenderEngine& renderEngine, const Command& command)
+	{
+		switch (command.operation())
+		{
+			case Command::Operation::Ambient:
+			{
+				renderEngine.SetAmbientColor(std::get<Color>(command.parameters()));
+			} break;
+
+			case Command::Operation::Depth:
+			{
+				auto params = std::get<DepthParams>(command.parameters());
+				renderEngine.SetDepth(Depth{ params.near, params.far, params.color });
+			} break;
+
+			case Command::Operation::Surface:
+			{
+				auto params = std::get<SurfaceParams>(command.parameters());
+				renderEngine.SetSpecularCoefficient(params[0]);
+				renderEngine.SetSpecularExponent(params[1]);
+			} break;
+
+			case Command::Operation::Multisample:
+			{
+				renderEngine.SetMultisampling(std::get<MultisampleParams>(command.parameters()).sampleCount);
+			} break;
+
+			case Command::Operation::Aliased:
+			{
+				renderEngine.SetLineMode(RenderEngine::LineMode::Aliased);
+			} break;
+
+			case Command::Operation::Antialiased:
+			{
+				renderEngine.SetLineMode(RenderEngine::LineMode::Antialiased);
+			} break;
+
+			case Command::Operation::Phong:
+			case Command::Operation::Gouraud:
+			case Command::Operation::Flat:
+			{
+				renderEngine.SetLightingMethod(std::get<LightingMethod>(command.parameters()));
+			} break;
+
+			default:
+			{
+
+			} break;
+		}
+	}
+
+	// Commands and stream views share it, both have operation() and get<T>()
+	template <typename CommandView>
+	CTM_t transformFrom(const CommandView& command)
+	{
+		switch (command.operation())
+		{
+			case Command::Operation::Scale:
+			{
+				return SceneGraph::scaleMatrix(command.template get<Vector3>());
+			} break;
+
+			case Command::Operation::Translate:
+			{
+				return SceneGraph::translateMatrix(command.template get<Vector3>());
+			} break;
+
+			case Command::Operation::Rotate:
+			{
+				auto params = command.template get<RotateParams>();
+				return SceneGraph::rotateMatrix(params.first, params.second);
+			} break;
+
+			default:
+			{
+				throw std::invalid_argument("Command is not a transform");
+			}
+		}
+	}
+}
+
+SceneGraph::SceneGraph(const CommandStream& commands)
+{
+	std::vector<int> openGroups;
+	auto base = -1;
+	auto renderMode = RenderEngine::RenderMode::Filled;
+	auto creaseAngle = 180;
+	std::stack<MeshBuilder> meshBuilders;
+	std::unordered_map<std::string, std::size_t> meshIndices;
+	auto builtMeshes = std::make_shared<std::vector<Mesh>>();
+	std::vector<std::size_t> depths;
+	// Transform or camera the next key applies to
+	auto lastAnimated = -1;
+
+	auto addNode = [&](NodeType type, std::size_t item)
+	{
+		auto index = _nodes.size();
+		_nodes.push_back(Node{ type, openGroups.empty() ? -1 : openGroups.back(), base, index + 1, item, identity });
+		depths.push_back(base < 0 ? 0 : depths[base] + 1);
+		return index;
+	};
+
+	auto addMesh = [&](std::size_t mesh)
+	{
+		addNode(NodeType::Mesh, meshItems.size());
+		meshItems.push_back(MeshItem{ mesh, renderMode });
+	};
+
+	for (const auto& command : commands)
+	{
+		switch (command.operation())
+		{
+			case Command::Operation::OpenBrace:
+			{
+				auto group = addNode(NodeType::Group, 0);
+				openGroups.push_back(static_cast<int>(group));
+				base = static_cast<int>(group);
+			} break;
+
+			case Command::Operation::CloseBrace:
+			{
+				// The transforms of the block end with it, the next sibling
+				// starts where the group did
+				if (!openGroups.empty())
+				{
+					base = openGroups.back();
+					_nodes[base].end = _nodes.size();
+					openGroups.pop_back();
+				}
+			} break;
+
+			case Command::Operation::Scale:
+			case Command::Operation::Rotate:
+			case Command::Operation::Translate:
+			{
+				auto transform = addNode(NodeType::Transform, transforms.size());
+				_nodes[transform].local = transformOf(command);
+				transforms.push_back(command);
+				base = static_cast<int>(transform);
+				lastAnimated = static_cast<int>(transform);
+			} break;
+
+			case Command::Operation::Polygon:
+			{
+				addNode(NodeType::Polygon, polygons.size());
+				polygons.push_back(PolygonItem{ std::get<PolygonParams>(command.parameters()), renderMode });
+			} break;
+
+			case Command::Operation::Line:
+			{
+				addNode(NodeType::Line, lines.size());
+				lines.push_back(std::get<LineParams>(command.parameters()));
+			} break;
+
+			case Command::Operation::Light:
+			{
+				addNode(NodeType::Light, lights.size());
+				lights.push_back(std::get<LightParams>(command.parameters()));
+			} break;
+
+			case Command::Operation::Camera:
+			{
+				lastAnimated = static_cast<int>(addNode(NodeType::Camera, cameras.size()));
+				cameras.push_back(std::get<CameraParams>(command.parameters()));
+			} break;
+
+			case Command::Operation::Keyframe:
+			{
+				if (lastAnimated < 0)
+				{
+					throw std::invalid_argument("A key has to follow a transform or a camera");
+				}
+				_keyframes.emplace_back(lastAnimated, std::get<KeyframeParams>(command.parameters()));
+			} break;
+
+			case Command::Operation::Filled:
+			{
+				renderMode = RenderEngine::RenderMode::Filled;
+			} break;
+
+			case Command::Operation::Wire:
+			{
+				renderMode = RenderEngine::RenderMode::Wireframe;
+			} break;
+
+			case Command::Operation::Crease:
+			{
+				creaseAngle = std::get<CreaseParams>(command.parameters());
+			} break;
+
+			case Command::Operation::Vertex:
+			{
+				if (!meshBuilders.empty())
+				{
+					meshBuilders.top().addVertex(std::get<Point4D>(command.parameters()));
+				}
+			} break;
+
+			case Command::Operation::VertexNormal:
+			{
+				if (!meshBuilders.empty())
+				{
+					meshBuilders.top().addNormal(std::get<Vector3>(command.parameters()));
+				}
+			} break;
+
+			case Command::Operation::Face:
+			{
+				if (!meshBuilders.empty())
+				{
+					meshBuilders.top().addFace(std::get<FaceParam>(command.parameters()));
+				}
+			} break;
+
+			case Command::Operation::ObjectFile:
+			{
+				if (std::get<std::string>(command.parameters()) == "ENDOFOBJECTFILE"s)
+				{
+					if (!meshBuilders.empty())
+					{
+						auto mesh = meshBuilders.top().build();
+						meshBuilders.pop();
+
+						meshIndices[mesh.name] = builtMeshes->size();
+						meshBounds.push_back(boundsOf(mesh));
+						builtMeshes->push_back(std::move(mesh));
+						addMesh(builtMeshes->size() - 1);
+					}
+				}
+				else
+				{
+					meshBuilders.emplace(std::get<std::string>(command.parameters()), creaseAngle);
+				}
+			} break;
+
+			case Command::Operation::Instance:
+			{
+				auto mesh = meshIndices.find(std::get<std::string>(command.parameters()));
+				if (mesh == meshIndices.end())
+				{
+					throw std::invalid_argument("Cannot instance a mesh that was not loaded");
+				}
+				addMesh(mesh->second);
+			} break;
+
+			case Command::Operation::File:
+			{
+
+			} break;
+
+			default:
+			{
+				addNode(NodeType::Setting, settings.size());
+				settings.push_back(command);
+			} break;
+		}
+	}
+
+	meshes = std::move(builtMeshes);
+
+	// Blocks left open run to the end of the scene
+	for (auto group : openGroups)
+	{
+		_nodes[group].end = _nodes.size();
+	}
+
+	// A block that only draws can be skipped as a whole when it is out of view,
+	// settings, lights and cameras inside it have to run whatever it covers
+	cullable.assign(_nodes.size(), false);
+	for (auto i = 0u; i < _nodes.size(); ++i)
+	{
+		auto& node = _nodes[i];
+		auto drawsOnly = [](const Node& n) { return n.type != NodeType::Setting && n.type != NodeType::Light && n.type != NodeType::Camera; };
+		cullable[i] = node.type == NodeType::Mesh ||
+					  (node.type == NodeType::Group && std::all_of(_nodes.begin() + i + 1, _nodes.begin() + node.end, drawsOnly));
+	}
+
+	for (auto i = 0u; i < _nodes.size(); ++i)
+	{
+		if (depths[i] >= levels.size())
+		{
+			levels.resize(depths[i] + 1);
+		}
+		levels[depths[i]].push_back(i);
+	}
+
+	update();
+}
+
+CTM_t SceneGraph::transformOf(const Command& command)
+{
+	return transformFrom(command);
+}
+
+CTM_t SceneGraph::transformOf(const CommandStream::View& command)
+{
+	return transformFrom(command);
+}
+
+CTM_t SceneGraph::scaleMatrix(const Vector3& params)
+{
+	return CTM_t{ params[0], 0.0,		0.0,	   0.0,
+				  0.0,       params[1], 0.0,	   0.0,
+				  0.0,		 0.0,		params[2], 0.0,
+				  0.0,		 0.0,		0.0		 , 1.0 };
+}
+
+CTM_t SceneGraph::translateMatrix(const Vector3& params)
+{
+	return CTM_t{ 1.0, 0.0, 0.0, params[0],
+				  0.0, 1.0, 0.0, params[1],
+				  0.0, 0.0, 1.0, params[2],
+				  0.0, 0.0, 0.0, 1.0 };
+}
+
+CTM_t SceneGraph::rotateMatrix(Axis axis, double degrees)
+{
+	auto radian = -getRadianFromDegree(degrees);
+	switch (axis)
+	{
+		case Axis::X:
+		{
+			return CTM_t{ 1.0, 0.0,				 0.0,				0.0,
+						  0.0, std::cos(radian), -std::sin(radian), 0.0,
+						  0.0, std::sin(radian), std::cos(radian),  0.0,
+						  0.0, 0.0,				 0.0,				1.0 };
+		} break;
+
+		case Axis::Y:
+		{
+			return CTM_t{ std::cos(radian),	 0.0, std::sin(radian), 0.0,
+						  0.0,				 1.0, 0.0,				0.0,
+						  -std::sin(radian), 0.0, std::cos(radian), 0.0,
+						  0.0,				 0.0, 0.0,				1.0 };
+		} break;
+
+		case Axis::Z:
+		default:
+		{
+			return CTM_t{ std::cos(radian), -std::sin(radian), 0.0, 0.0,
+						  std::sin(radian), std::cos(radian),  0.0, 0.0,
+						  0.0,				0.0,			   1.0, 0.0,
+						  0.0,				0.0,			   0.0, 1.0 };
+		} break;
+	}
+}
+
+void SceneGraph::update()
+{
+	worldMatrices.resize(_nodes.size());
+	worldBounds.assign(_nodes.size(), std::nullopt);
+
+	// Each level only reads matrices of the levels before it
+	for (auto& level : levels)
+	{
+		JobSystem::shared().parallelFor(level.size(), [this, &level](std::size_t l)
+		{
+			auto i = level[l];
+			auto& node = _nodes[i];
+			auto start = node.base < 0 ? identity : worldMatrices[node.base];
+			auto local = node.local;
+			worldMatrices[i] = node.type == NodeType::Transform ? start * local : start;
+		}, "world matrices", 256);
+	}
+
+	JobSystem::shared().parallelFor(_nodes.size(), [this](std::size_t i)
+	{
+		auto& node = _nodes[i];
+		switch (node.type)
+		{
+			case NodeType::Polygon:
+			{
+				worldBounds[i] = transformBounds(boundsOf(polygons[node.item].vertices), worldMatrices[i]);
+			} break;
+
+			case NodeType::Line:
+			{
+				worldBounds[i] = transformBounds(boundsOf(lines[node.item]), worldMatrices[i]);
+			} break;
+
+			case NodeType::Mesh:
+			{
+				worldBounds[i] = transformBounds(meshBounds[meshItems[node.item].mesh], worldMatrices[i]);
+			} break;
+
+			default:
+			{
+
+			} break;
+		}
+	}, "bounds", 256);
+
+	// Children always come after their group, so one backwards pass fills every group
+	for (auto i = _nodes.size(); i-- > 0;)
+	{
+		if (worldBounds[i].has_value() && _nodes[i].parent >= 0)
+		{
+			merge(worldBounds[_nodes[i].parent], *worldBounds[i]);
+		}
+	}
+}
+
+Camera SceneGraph::cameraFrom(const CTM_t& placement, const CameraParams& params)
+{
+	auto inverse = invert(placement);
+	return Camera{ inverse, params.xLow, params.xHigh, params.yLow, params.yHigh, params.near, params.far };
+}
+
+void SceneGraph::render(RenderEngine& renderEngine) const
+{
+	draw(renderEngine, std::nullopt);
+}
+
+void SceneGraph::render(RenderEngine& renderEngine, const Camera& camera) const
+{
+	renderEngine.SetCamera(camera);
+	renderEngine.ClearDepthBuffer();
+	draw(renderEngine, camera);
+}
+
+std::optional<Camera> SceneGraph::camera() const
+{
+	for (auto i = _nodes.size(); i-- > 0;)
+	{
+		if (_nodes[i].type == NodeType::Camera)
+		{
+			return cameraFrom(worldMatrices[i], cameras[_nodes[i].item]);
+		}
+	}
+	return std::nullopt;
+}
+
+void SceneGraph::render(std::vector<RenderEngine>& renderEngines, const std::vector<Camera>& views) const
+{
+	if (renderEngines.size() != views.size())
+	{
+		throw std::invalid_argument("Every view needs its own render engine");
+	}
+
+	// Matrices, meshes and bounds are shared, each view only rasterizes into its own buffers
+	JobSystem::shared().parallelFor(views.size(), [&](std::size_t i)
+	{
+		render(renderEngines[i], views[i]);
+	}, "view");
+}
+
+void SceneGraph::draw(RenderEngine& renderEngine, const std::optional<Camera>& fixedCamera) const
+{
+	auto cameraInverse = fixedCamera.has_value() ? fixedCamera->transformationMatrix : identity;
+	// Nothing can be culled against the engine's camera until one is placed
+	auto cameraPlaced = fixedCamera.has_value();
+	for (auto i = 0u; i < _nodes.size(); ++i)
+	{
+		auto& node = _nodes[i];
+		if (cameraPlaced && cullable[i] && worldBounds[i].has_value() &&
+			!renderEngine.BoxInView(cornersOf(*worldBounds[i], cameraInverse)))
+		{
+			i = static_cast<unsigned>(node.end) - 1;
+			continue;
+		}
+
+		auto world = worldMatrices[i];
+		switch (node.type)
+		{
+			case NodeType::Camera:
+			{
+				if (!fixedCamera.has_value())
+				{
+					auto camera = cameraFrom(world, cameras[node.item]);
+					cameraInverse = camera.transformationMatrix;
+					cameraPlaced = true;
+					renderEngine.SetCamera(camera);
+					renderEngine.ClearDepthBuffer();
+				}
+			} break;
+
+			case NodeType::Light:
+			{
+				auto& params = lights[node.item];
+				auto lightColor = Color::getDenormalizedColor(params[0], params[1], params[2]);
+				auto lightPosition = world * Vector4_t{ 0, 0, 0, 1 };
+				lightPosition = cameraInverse * lightPosition;
+				renderEngine.AddLight(Light{ lightPosition, lightColor, params[3], params[4] });
+			} break;
+
+			case NodeType::Polygon:
+			{
+				auto& item = polygons[node.item];
+				Polygon_t triangle;
+				for (auto& p : item.vertices)
+				{
+					triangle.push_back(Point4D{ cameraInverse * (world * Vector4_t{ p.x, p.y, p.z, 1 }), p.color });
+				}
+				renderEngine.RenderTriangle(triangle, item.renderMode);
+			} break;
+
+			case NodeType::Line:
+			{
+				auto& params = lines[node.item];
+				renderEngine.RenderLine(Line_t{ Point4D{ cameraInverse * (world * Vector4_t{ params[0].x, params[0].y, params[0].z, 1 }), params[0].color },
+												Point4D{ cameraInverse * (world * Vector4_t{ params[1].x, params[1].y, params[1].z, 1 }), params[1].color } });
+			} break;
+
+			case NodeType::Mesh:
+			{
+				auto& item = meshItems[node.item];
+				renderEngine.RenderMesh((*meshes)[item.mesh], cameraInverse * world, item.renderMode);
+			} break;
+
+			case NodeType::Setting:
+			{
+				applySetting(renderEngine, settings[node.item]);
+			} break;
+
+			default:
+			{
+
+			} break;
+		}
+	}
+}
+
+void SceneGraph::setTransform(std::size_t node, const CTM_t& local)
+{
+	if (node >= _nodes.size() || _nodes[node].type != NodeType::Transform)
+	{
+		throw std::invalid_argument("Node is not a transform");
+	}
+	_nodes[node].local = local;
+}
+
+const Command& SceneGraph::transformCommand(std::size_t node) const
+{
+	if (node >= _nodes.size() || _nodes[node].type != NodeType::Transform)
+	{
+		throw std::invalid_argument("Node is not a transform");
+	}
+	return transforms[_nodes[node].item];
+}
+
+const CameraParams& SceneGraph::cameraParams(std::size_t node) const
+{
+	if (node >= _nodes.size() || _nodes[node].type != NodeType::Camera)
+	{
+		throw std::invalid_argument("Node is not a camera");
+	}
+	return cameras[_nodes[node].item];
+}
+
+void SceneGraph::setCameraParams(std::size_t node, const CameraParams& params)
+{
+	if (node >= _nodes.size() || _nodes[node].type != NodeType::Camera)
+	{
+		throw std::invalid_argument("Node is not a camera");
+	}
+	cameras[_nodes[node].item] = params;
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "CommonTypeAliases.hpp"
+#include "command.hpp"
+#include "CommandStream.hpp"
+#include "Mesh.hpp"
+#include "RenderingEngine.hpp"
+
+// Axis aligned box in world space
+struct Bounds
+{
+	std::array<double, 3> min;
+	std::array<double, 3> max;
+};
+
+// Retained form of a SIMP command stream. Brace blocks become group nodes,
+// transforms, geometry, lights and cameras become nodes under them, in the
+// order they were declared. World matrices and bounds are cached, so the
+// scene can be drawn any number of times without interpreting commands.
+class SceneGraph
+{
+public:
+	enum class NodeType
+	{
+		Group,
+		Transform,
+		Polygon,
+		Line,
+		Mesh,
+		Light,
+		Camera,
+		Setting
+	};
+
+	struct Node
+	{
+		NodeType type;
+		// Enclosing group, -1 at the top level
+		int parent;
+		// Node whose world matrix this one starts from: the previous transform
+		// in the same block, or the enclosing group
+		int base;
+		// One past the last node of the subtree
+		std::size_t end;
+		// Index into the array for the node type
+		std::size_t item;
+		// Only used by transforms
+		CTM_t local;
+	};
+
+	explicit SceneGraph(const CommandStream& commands);
+
+	// Scale, rotate and translate as a matrix
+	static CTM_t transformOf(const Command& command);
+	static CTM_t transformOf(const CommandStream::View& command);
+
+	static CTM_t scaleMatrix(const Vector3& params);
+
+	static CTM_t translateMatrix(const Vector3& params);
+
+	static CTM_t rotateMatrix(Axis axis, double degrees);
+
+	// Recomputes world matrices and bounds, sibling blocks in parallel
+	void update();
+
+	// Camera looking down -z from a placement in world space
+	static Camera cameraFrom(const CTM_t& placement, const CameraParams& params);
+
+	// Draws every node in declaration order, the same as interpreting the commands
+	void render(RenderEngine& renderEngine) const;
+
+	// Draws the scene from camera, the cameras it places are ignored and every
+	// light and primitive goes from world space straight through camera
+	void render(RenderEngine& renderEngine, const Camera& camera) const;
+
+	// One view per engine, drawn in parallel. Each engine brings its own
+	// viewport, buffers and draw surface
+	void render(std::vector<RenderEngine>& renderEngines, const std::vector<Camera>& views) const;
+
+	// The last camera the scene places, empty when it has none
+	std::optional<Camera> camera() const;
+
+	void setTransform(std::size_t node, const CTM_t& local);
+
+	// The command a transform node was built from
+	const Command& transformCommand(std::size_t node) const;
+
+	const CameraParams& cameraParams(std::size_t node) const;
+
+	void setCameraParams(std::size_t node, const CameraParams& params);
+
+	// Key commands with the transform or camera node they follow
+	const std::vector<std::pair<std::size_t, KeyframeParams>>& keyframes() const
+	{
+		return _keyframes;
+	}
+
+	const std::vector<Node>& nodes() const
+	{
+		return _nodes;
+	}
+
+	const CTM_t& worldMatrix(std::size_t node) const
+	{
+		return worldMatrices[node];
+	}
+
+	// Empty for nodes that draw nothing
+	const std::optional<Bounds>& bounds(std::size_t node) const
+	{
+		return worldBounds[node];
+	}
+
+private:
+	struct PolygonItem
+	{
+		PolygonParams vertices;
+		RenderEngine::RenderMode renderMode;
+	};
+
+	struct MeshItem
+	{
+		std::size_t mesh;
+		RenderEngine::RenderMode renderMode;
+	};
+
+	void draw(RenderEngine& renderEngine, const std::optional<Camera>& fixedCamera) const;
+
+	std::vector<Node> _nodes;
+	std::vector<CTM_t> worldMatrices;
+	std::vector<std::optional<Bounds>> worldBounds;
+	// Nodes grouped by how many matrix products they are from the root,
+	// every node of a level only depends on earlier levels
+	std::vector<std::vector<std::size_t>> levels;
+	// Groups and meshes that can be skipped when their bounds are out of view
+	std::vector<bool> cullable;
+
+	std::vector<PolygonItem> polygons;
+	std::vector<LineParams> lines;
+	std::vector<MeshItem> meshItems;
+	// Built once, copies of the graph share them
+	std::shared_ptr<const std::vector<Mesh>> meshes;
+	std::vector<Bounds> meshBounds;
+	std::vector<LightParams> lights;
+	std::vector<CameraParams> cameras;
+	std::vector<Command> settings;
+	std::vector<Command> transforms;
+	std::vector<std::pair<std::size_t, KeyframeParams>> _keyframes;
+};
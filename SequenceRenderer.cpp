@@ -0,0 +1,117 @@
+#include "SequenceRenderer.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+
+#include "ClippedDrawable.hpp"
+#include "JobSystem.hpp"
+#include "RenderingEngine.hpp"
+
+namespace
+{
+	void writeRGB(std::ostream& stream, const FrameBuffer& image)
+	{
+		std::vector<char> bytes;
+		bytes.reserve(image.data().size() * 3);
+		for (auto color : image.data())
+		{
+			bytes.push_back(static_cast<char>((color >> 16) & 0xff));
+			bytes.push_back(static_cast<char>((color >> 8) & 0xff));
+			bytes.push_back(static_cast<char>(color & 0xff));
+		}
+		stream.write(bytes.data(), bytes.size());
+	}
+}
+
+namespace SequenceRenderer
+{
+	void render(const SceneGraph& scene, const Animation& animation, const Rect& viewPort, int first, int last, const FrameSink& sink)
+	{
+		auto& jobSystem = JobSystem::shared();
+		auto workers = jobSystem.workerCount();
+
+		// A window of frames is in flight at a time, so long sequences do not
+		// hold every image
+		auto windowSize = 2 * workers;
+		for (auto windowStart = first; windowStart <= last; windowStart += windowSize)
+		{
+			auto count = std::min(windowSize, last - windowStart + 1);
+			// Cores left over when there are few frames split each frame into bands
+			auto bandCount = std::max(1, (workers + count - 1) / count);
+
+			std::vector<FrameBuffer> images(count, FrameBuffer(viewPort));
+			std::vector<std::optional<SceneGraph>> poses(count);
+
+			TaskGraph graph;
+			std::optional<TaskGraph::JobId_t> previousEncode;
+			for (auto i = 0; i < count; ++i)
+			{
+				auto frame = windowStart + i;
+				auto pose = graph.add("pose " + std::to_string(frame), [&, i, frame]()
+				{
+					poses[i].emplace(scene);
+					animation.pose(*poses[i], frame);
+				});
+
+				std::vector<TaskGraph::JobId_t> rasterJobs;
+				for (auto b = 0; b < bandCount; ++b)
+				{
+					rasterJobs.push_back(graph.add("raster " + std::to_string(frame), [&, i, b]()
+					{
+						auto top = viewPort.y + viewPort.height * b / bandCount;
+						auto bottom = viewPort.y + viewPort.height * (b + 1) / bandCount;
+						auto band = Rect{ viewPort.x, top, viewPort.width, bottom - top };
+
+						ClippedDrawable surface(&images[i], band);
+						RenderEngine renderEngine{ viewPort, &surface, Color{ 255, 255, 255 } };
+						renderEngine.SetClipRegion(band);
+						renderEngine.SetRasterBand(band);
+						poses[i]->render(renderEngine);
+					}, { pose }));
+				}
+
+				// Frames reach the sink in order
+				auto encodeDependencies = rasterJobs;
+				if (previousEncode.has_value())
+				{
+					encodeDependencies.push_back(*previousEncode);
+				}
+				previousEncode = graph.add("encode " + std::to_string(frame), [&, i, frame]()
+				{
+					poses[i].reset();
+					sink(frame, images[i]);
+				}, encodeDependencies);
+			}
+
+			graph.run(jobSystem);
+		}
+	}
+
+	FrameSink numberedImages(const std::string& prefix)
+	{
+		return [prefix](int frame, const FrameBuffer& image)
+		{
+			std::ostringstream fileName;
+			fileName << prefix << std::setw(4) << std::setfill('0') << frame << ".ppm";
+			std::ofstream file(fileName.str(), std::ios::binary);
+			if (!file)
+			{
+				throw std::invalid_argument("Cannot open file");
+			}
+			file << "P6\n" << image.width() << " " << image.height() << "\n255\n";
+			writeRGB(file, image);
+		};
+	}
+
+	FrameSink rawVideo(std::ostream& stream)
+	{
+		return [&stream](int, const FrameBuffer& image)
+		{
+			writeRGB(stream, image);
+		};
+	}
+}
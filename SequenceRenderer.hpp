@@ -0,0 +1,75 @@
+#pragma once
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Animation.hpp"
+#include "drawable.h"
+#include "primitives.hpp"
+#include "SceneGraph.hpp"
+
+// Off screen image of one frame, covering a viewport in surface coordinates
+class FrameBuffer : public Drawable
+{
+public:
+	explicit FrameBuffer(const Rect& area) : area(area), pixels(static_cast<std::size_t>(area.width) * area.height, 0) {}
+
+	void setPixel(int x, int y, unsigned int color) override
+	{
+		if (x >= area.x && x < area.right() && y >= area.y && y < area.bottom())
+		{
+			pixels[index(x, y)] = color;
+		}
+	}
+
+	unsigned int getPixel(int x, int y) override
+	{
+		return pixels[index(x, y)];
+	}
+
+	void updateScreen() override {}
+
+	int width() const
+	{
+		return area.width;
+	}
+
+	int height() const
+	{
+		return area.height;
+	}
+
+	// 0xRRGGBB, row by row from the top left
+	const std::vector<unsigned int>& data() const
+	{
+		return pixels;
+	}
+
+private:
+	std::size_t index(int x, int y) const
+	{
+		return static_cast<std::size_t>(y - area.y) * area.width + (x - area.x);
+	}
+
+	Rect area;
+	std::vector<unsigned int> pixels;
+};
+
+namespace SequenceRenderer
+{
+	using FrameSink = std::function<void(int frame, const FrameBuffer& image)>;
+
+	// Renders frames [first, last] of an animated scene as a task graph on the
+	// shared job system: pose, then raster, split into bands when there are
+	// more cores than frames, then encode. Every frame poses its own copy of
+	// the graph, the meshes are shared. sink sees the frames one at a time
+	// and in order.
+	void render(const SceneGraph& scene, const Animation& animation, const Rect& viewPort, int first, int last, const FrameSink& sink);
+
+	// Binary PPM per frame, named prefix0001.ppm and on
+	FrameSink numberedImages(const std::string& prefix);
+
+	// Frames back to back as 8 bit RGB, e.g. for ffmpeg -f rawvideo -pix_fmt rgb24
+	FrameSink rawVideo(std::ostream& stream);
+}
@@ -1,333 +1,760 @@
 #include "SimpEngine.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#include "ClippedDrawable.hpp"
 #include "Light.hpp"
 
-void SimpEngine::runCommands(const std::vector<Command>& commands)
+namespace
 {
-	for (auto& command : commands)
+	// Polygons and lines are drawn in batches of this size at most, so the
+	// raster workers do not wait for a long run of them to end
+	constexpr std::size_t BatchSize = 256;
+
+	// Vertices this far back in a batch are compared against a new one, the
+	// triangles of a quad or the lines of a polyline share theirs with the
+	// ones just before
+	constexpr std::size_t SharedVertexWindow = 6;
+
+	template <typename Batch>
+	std::uint32_t addBatchVertex(Batch& batch, const Point4D& vertex)
 	{
-		switch (command.operation())
+		auto first = batch.vertices.size() > SharedVertexWindow ? batch.vertices.size() - SharedVertexWindow : 0;
+		for (auto i = batch.vertices.size(); i > first; --i)
 		{
-			case Command::Operation::Filled:
+			auto& other = batch.vertices[i - 1];
+			if (other.x == vertex.x && other.y == vertex.y && other.z == vertex.z && other.w == vertex.w &&
+				other.color.r == vertex.color.r && other.color.g == vertex.color.g && other.color.b == vertex.color.b)
 			{
-				currentRenderMode = RenderEngine::RenderMode::Filled;
-			} break;
+				return static_cast<std::uint32_t>(i - 1);
+			}
+		}
+
+		batch.vertices.push_back(vertex);
+		return static_cast<std::uint32_t>(batch.vertices.size() - 1);
+	}
 
-			case Command::Operation::Wire:
+	bool isTransform(Command::Operation op)
+	{
+		return op == Command::Operation::Scale || op == Command::Operation::Rotate || op == Command::Operation::Translate;
+	}
+
+	// Geometry only draws, it leaves no state behind for later commands
+	bool isGeometry(Command::Operation op)
+	{
+		switch (op)
+		{
+			case Command::Operation::Line:
+			case Command::Operation::Polygon:
+			case Command::Operation::Vertex:
+			case Command::Operation::VertexNormal:
+			case Command::Operation::Face:
+			case Command::Operation::Instance:
 			{
-				currentRenderMode = RenderEngine::RenderMode::Wireframe;
+				return true;
 			} break;
 
-			case Command::Operation::OpenBrace:
+			default:
 			{
-				TransformStack.push(CTM);
+				return false;
+			}
+		}
+	}
+}
 
-			} break;
+void SimpEngine::runCommands(const CommandStream& commands)
+{
+	for (std::size_t i = 0; i < commands.size(); ++i)
+	{
+		runCommand(commands.view(i));
+	}
+	flushBatches();
+}
 
-			case Command::Operation::CloseBrace:
-			{
-				if (!TransformStack.empty())
-				{
-					CTM = std::move(TransformStack.top());
-					TransformStack.pop();
-				}
-			} break;
+void SimpEngine::runFile(const SimpFile& file)
+{
+	file.forEachCommand([this](const Command& command) { runCommand(command); });
+	flushBatches();
+}
+
+void SimpEngine::runCommandsPipelined(const CommandStream& commands, int rasterThreads)
+{
+	if (rasterThreads <= 0)
+	{
+		rasterThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	}
+
+	pipeline = std::make_unique<RenderPipeline>(_renderEngine, rasterThreads);
+	try
+	{
+		runCommands(commands);
+	}
+	catch (...)
+	{
+		// What was submitted before the throw is still drawn, and later runs
+		// must not feed a pipeline nobody finishes
+		endPipeline();
+		throw;
+	}
+	endPipeline();
+}
+
+void SimpEngine::endPipeline()
+{
+	pipeline->finish();
+
+	// The workers drew in bands, their depth buffers are not merged back
+	_renderEngine.RestoreSettings(pipeline->settings());
+	_renderEngine.SetClipRegion(std::nullopt);
+	pipeline.reset();
+}
+
+void SimpEngine::retainCommands(const CommandStream& commands)
+{
+	initialSettings.emplace(_renderEngine);
+	retainedCommands = commands;
+	sceneGraph.reset();
+	retainedGroups.clear();
+	retainedMeshes.clear();
+	groupCommands(0, retainedCommands.size());
+
+	resetInterpreter();
+	_renderEngine.TakeDrawnBounds();
+	for (auto& group : retainedGroups)
+	{
+		runGroup(group);
+	}
+}
+
+void SimpEngine::replaceCommand(std::size_t index, const Command& command)
+{
+	if (index >= retainedCommands.size())
+	{
+		throw std::invalid_argument("No retained command at that index");
+	}
+
+	auto replaced = retainedCommands.operation(index);
+	auto isBrace = [](Command::Operation op) { return op == Command::Operation::OpenBrace || op == Command::Operation::CloseBrace; };
+	if (isBrace(command.operation()) || isBrace(replaced))
+	{
+		throw std::invalid_argument("Cannot change the block structure of a retained scene");
+	}
+
+	auto group = std::prev(std::upper_bound(retainedGroups.begin(), retainedGroups.end(), index, [](std::size_t i, const RetainedGroup& g) { return i < g.begin; }));
+	auto insideBlock = retainedCommands.operation(group->begin) == Command::Operation::OpenBrace;
+
+	// Settings outlive their block, and a transform outside of a block moves
+	// everything after it, the camera included
+	auto setsState = [](Command::Operation op) { return !isTransform(op) && !isGeometry(op); };
+	auto movesCamera = false;
+	for (auto i = index; !insideBlock && i < retainedCommands.size(); ++i)
+	{
+		movesCamera = movesCamera || retainedCommands.operation(i) == Command::Operation::Camera;
+	}
+
+	// Instances anywhere after an obj include draw the mesh it builds
+	auto isMeshPart = [](Command::Operation op)
+	{
+		return op == Command::Operation::Vertex || op == Command::Operation::VertexNormal || op == Command::Operation::Face;
+	};
+	auto editsMesh = isMeshPart(command.operation()) || isMeshPart(replaced);
+	retainedCommands.replace(index, command);
+	sceneGraph.reset();
+
+	// A mesh is built again when one of its commands changes
+	for (auto mesh = retainedMeshes.begin(); mesh != retainedMeshes.end();)
+	{
+		mesh = index >= mesh->first && index <= mesh->second.end ? retainedMeshes.erase(mesh) : std::next(mesh);
+	}
+
+	if (setsState(command.operation()) || setsState(replaced) || movesCamera)
+	{
+		for (auto& g : retainedGroups)
+		{
+			g.dirty = true;
+		}
+	}
+	else if (!insideBlock || editsMesh)
+	{
+		std::for_each(group, retainedGroups.end(), [](RetainedGroup& g) { g.dirty = true; });
+	}
+	else
+	{
+		group->dirty = true;
+	}
+}
 
-			case Command::Operation::Scale:
+void SimpEngine::renderChanges(unsigned int backgroundColor)
+{
+	std::optional<Rect> region;
+	for (auto& group : retainedGroups)
+	{
+		if (group.dirty && group.bounds.has_value())
+		{
+			region = region.has_value() ? unite(*region, *group.bounds) : *group.bounds;
+		}
+	}
+
+	if (region.has_value())
+	{
+		_renderEngine.ClearRegion(*region, backgroundColor);
+	}
+
+	redrawing = true;
+	_renderEngine.RestoreSettings(*initialSettings);
+	resetInterpreter();
+
+	// Unchanged blocks are only drawn again where the changed ones used to be,
+	// changed blocks are drawn in full against the depth already on screen
+	auto surface = _renderEngine.GetDrawSurface();
+	auto clip = region.value_or(Rect{ 0, 0, 0, 0 });
+	ClippedDrawable clippedSurface(surface, clip);
+	for (auto& group : retainedGroups)
+	{
+		if (!group.dirty && !(group.bounds.has_value() && intersect(*group.bounds, clip).has_value()) && skipGroup(group))
+		{
+			continue;
+		}
+
+		_renderEngine.SetDrawSurface(group.dirty ? surface : &clippedSurface);
+		_renderEngine.SetClipRegion(group.dirty ? std::nullopt : std::optional<Rect>(clip));
+		runGroup(group);
+	}
+
+	_renderEngine.SetDrawSurface(surface);
+	_renderEngine.SetClipRegion(std::nullopt);
+	redrawing = false;
+}
+
+void SimpEngine::renderView(const Camera& camera, unsigned int backgroundColor)
+{
+	auto& scene = retainedScene();
+
+	_renderEngine.RestoreSettings(*initialSettings);
+	_renderEngine.SetCamera(camera);
+	_renderEngine.ClearRegion(_renderEngine.GetViewPort(), backgroundColor);
+	scene.render(_renderEngine, camera);
+
+	// What the blocks covered from the scene camera no longer holds, the next
+	// renderChanges has to start over from the whole screen
+	_renderEngine.TakeDrawnBounds();
+	for (auto& group : retainedGroups)
+	{
+		group.bounds = _renderEngine.GetViewPort();
+		group.dirty = true;
+	}
+}
+
+std::optional<Camera> SimpEngine::sceneCamera()
+{
+	return retainedScene().camera();
+}
+
+SceneGraph& SimpEngine::retainedScene()
+{
+	if (!initialSettings.has_value())
+	{
+		throw std::invalid_argument("No retained scene, call retainCommands first");
+	}
+
+	if (!sceneGraph.has_value())
+	{
+		sceneGraph.emplace(retainedCommands);
+	}
+	return *sceneGraph;
+}
+
+void SimpEngine::groupCommands(std::size_t begin, std::size_t end)
+{
+	// Matching close brace of the block opened at begin, or end when it is never closed
+	auto closeOf = [this, end](std::size_t open)
+	{
+		auto depth = 0;
+		for (auto i = open; i < end; ++i)
+		{
+			auto op = retainedCommands.operation(i);
+			if (op == Command::Operation::OpenBrace)
 			{
-				auto params = std::get<Vector3>(command.parameters());
-				auto scaleMatrix = CTM_t{ params[0], 0.0,		0.0,	   0.0,
-										  0.0,       params[1], 0.0,	   0.0,
-										  0.0,		 0.0,		params[2], 0.0,
-										  0.0,		 0.0,		0.0		 , 1.0 };
-				CTM = CTM * scaleMatrix;
-			} break;
+				++depth;
+			}
+			else if (op == Command::Operation::CloseBrace && --depth == 0)
+			{
+				return i;
+			}
+		}
+		return end - 1;
+	};
 
-			case Command::Operation::Translate:
+	// Blocks that place a camera or a light affect the whole scene, they are
+	// split further so the blocks inside them can still change on their own
+	auto placesViewOrLight = [this](std::size_t first, std::size_t last)
+	{
+		for (auto i = first; i <= last; ++i)
+		{
+			auto op = retainedCommands.operation(i);
+			if (op == Command::Operation::Camera || op == Command::Operation::Light)
 			{
-				auto params = std::get<Vector3>(command.parameters());
-				auto translationMatrix = CTM_t{ 1.0, 0.0, 0.0, params[0],
-												0.0, 1.0, 0.0, params[1],
-												0.0, 0.0, 1.0, params[2],
-												0.0, 0.0, 0.0, 1.0 };
-				CTM = CTM * translationMatrix;
-			} break;
+				return true;
+			}
+		}
+		return false;
+	};
 
-			case Command::Operation::Rotate:
+	// Command ending the obj include started at begin, or end when it is never ended
+	auto endOf = [this, end](std::size_t start)
+	{
+		auto depth = 0;
+		for (auto i = start; i < end; ++i)
+		{
+			if (retainedCommands.operation(i) == Command::Operation::ObjectFile)
 			{
-				auto params = std::get<RotateParams>(command.parameters());
-				auto rotationMatrix = getRotationMatrix(params.first, params.second);
+				depth += retainedCommands.get<FileParam>(i) == "ENDOFOBJECTFILE"s ? -1 : 1;
+				if (depth <= 0)
+				{
+					return i;
+				}
+			}
+		}
+		return end - 1;
+	};
 
-				CTM = CTM * rotationMatrix;
-			} break;
+	auto i = begin;
+	while (i < end)
+	{
+		// An obj include is one group, so its mesh is built and kept in one go
+		if (retainedCommands.operation(i) == Command::Operation::ObjectFile)
+		{
+			auto last = endOf(i);
+			retainedGroups.push_back(RetainedGroup{ i, last + 1, std::nullopt, false });
+			i = last + 1;
+			continue;
+		}
 
-			case Command::Operation::Line:
-			{
-				auto params = std::get<LineParams>(command.parameters());
-				auto point1 = std::array<double, 4>{ params[0].x, params[0].y, params[0].z, 1 };
-				auto point2 = std::array<double, 4>{ params[1].x, params[1].y, params[1].z, 1 };
-				auto transformedPoint1 = cameraCTMInv * (CTM * point1);
-				auto transformedPoint2 = cameraCTMInv * (CTM * point2);
-
-				// Send to rendering engine to render
-				_renderEngine.RenderLine(Line_t { Point4D {transformedPoint1, params[0].color}, Point4D{transformedPoint2, params[1].color} });
-			} break;
+		if (retainedCommands.operation(i) != Command::Operation::OpenBrace)
+		{
+			retainedGroups.push_back(RetainedGroup{ i, i + 1, std::nullopt, false });
+			++i;
+			continue;
+		}
 
-			case Command::Operation::Polygon:
+		auto close = closeOf(i);
+		if (!placesViewOrLight(i, close))
+		{
+			retainedGroups.push_back(RetainedGroup{ i, close + 1, std::nullopt, false });
+		}
+		else
+		{
+			retainedGroups.push_back(RetainedGroup{ i, i + 1, std::nullopt, false });
+			groupCommands(i + 1, close);
+			if (close > i)
 			{
-				auto params = std::get<PolygonParams>(command.parameters());
-				auto point1 = std::array<double, 4>{ params[0].x, params[0].y, params[0].z, 1 };
-				auto point2 = std::array<double, 4>{ params[1].x, params[1].y, params[1].z, 1 };
-				auto point3 = std::array<double, 4>{ params[2].x, params[2].y, params[2].z, 1 };
-				auto transformedPoint1 = cameraCTMInv * (CTM * point1);
-				auto transformedPoint2 = cameraCTMInv * (CTM * point2);
-				auto transformedPoint3 = cameraCTMInv * (CTM * point3);
-
-				// Send to rendering engine to render
-				_renderEngine.RenderTriangle(Polygon_t{ Point4D{transformedPoint1, params[0].color},
-														Point4D{transformedPoint2, params[1].color},
-														Point4D{transformedPoint3, params[2].color} },
-											 currentRenderMode);
-			} break;
+				retainedGroups.push_back(RetainedGroup{ close, close + 1, std::nullopt, false });
+			}
+		}
+		i = close + 1;
+	}
+}
 
-			case Command::Operation::Ambient:
-			{
-				auto color = std::get<Color>(command.parameters());
-				_renderEngine.SetAmbientColor(color);
-			} break;
+void SimpEngine::resetInterpreter()
+{
+	CTM = CTM_t{ 1.0, 0.0, 0.0, 0.0,
+				 0.0, 1.0, 0.0, 0.0,
+				 0.0, 0.0, 1.0, 0.0,
+				 0.0, 0.0, 0.0, 1.0 };
+	cameraCTMInv = CTM;
+	TransformStack = std::stack<CTM_t>();
+	meshBuilders = std::stack<MeshBuilder>();
+	meshes.clear();
+	currentRenderMode = RenderEngine::RenderMode::Filled;
+	creaseAngle = 180;
+}
+
+void SimpEngine::runGroup(RetainedGroup& group)
+{
+	_renderEngine.TakeDrawnBounds();
+
+	// Obj includes being built, by the index of the command starting them
+	std::stack<std::size_t> meshStarts;
+	for (auto i = group.begin; i < group.end; ++i)
+	{
+		if (retainedCommands.operation(i) != Command::Operation::ObjectFile)
+		{
+			runCommand(retainedCommands.view(i));
+			continue;
+		}
+
+		// A mesh built before is drawn as it is, without its vertex and face commands
+		if (auto mesh = retainedMesh(i))
+		{
+			flushBatches();
+			renderMesh(mesh->mesh);
+			meshes[mesh->mesh->name] = mesh->mesh;
+			i = mesh->end;
+			continue;
+		}
 
-			case Command::Operation::Camera:
+		auto endsMesh = retainedCommands.get<FileParam>(i) == "ENDOFOBJECTFILE"s;
+		runCommand(retainedCommands.view(i));
+		if (!endsMesh)
+		{
+			meshStarts.push(i);
+		}
+		else if (!meshStarts.empty())
+		{
+			// Only plain meshes are kept, a nested include is drawn from inside the one around it
+			auto start = meshStarts.top();
+			meshStarts.pop();
+			auto plain = true;
+			for (auto j = start + 1; j < i; ++j)
 			{
-				auto params = std::get<CameraParams>(command.parameters());
-				cameraCTMInv = invert(CTM);
-				auto camera = Camera{ cameraCTMInv, params.xLow, params.xHigh, params.yLow, params.yHigh, params.near, params.far };
-				_renderEngine.SetCamera(camera);
-			} break;
+				plain = plain && isGeometry(retainedCommands.operation(j)) && retainedCommands.operation(j) != Command::Operation::Instance;
+			}
 
-			case Command::Operation::Depth:
+			auto name = retainedCommands.get<FileParam>(start);
+			if (plain && meshes.count(name) != 0)
 			{
-				auto params = std::get<DepthParams>(command.parameters());
-				_renderEngine.SetDepth(Depth{ params.near, params.far, params.color });
-			} break;
+				retainedMeshes[start] = RetainedMesh{ i, creaseAngle, meshes[name] };
+			}
+		}
+	}
+	flushBatches();
 
-			case Command::Operation::VertexNormal:
+	// Unchanged blocks are clipped, what they drew says nothing about their extent
+	auto bounds = _renderEngine.TakeDrawnBounds();
+	if (!redrawing || group.dirty)
+	{
+		group.bounds = bounds;
+		group.dirty = false;
+	}
+}
+
+const SimpEngine::RetainedMesh* SimpEngine::retainedMesh(std::size_t index) const
+{
+	auto mesh = retainedMeshes.find(index);
+	if (mesh == retainedMeshes.end() || mesh->second.creaseAngle != creaseAngle)
+	{
+		return nullptr;
+	}
+	return &mesh->second;
+}
+
+bool SimpEngine::skipGroup(const RetainedGroup& group)
+{
+	// Outside of a whole block only geometry leaves nothing behind, the braces
+	// of a block split around a camera or a light move the transform stack
+	auto wholeBlock = group.end - group.begin > 1 &&
+		retainedCommands.operation(group.begin) == Command::Operation::OpenBrace &&
+		retainedCommands.operation(group.end - 1) == Command::Operation::CloseBrace;
+
+	std::vector<std::shared_ptr<const Mesh>> groupMeshes;
+	for (auto i = group.begin; i < group.end; ++i)
+	{
+		auto op = retainedCommands.operation(i);
+		if (op == Command::Operation::ObjectFile)
+		{
+			auto mesh = retainedMesh(i);
+			if (mesh == nullptr)
 			{
-				normals.emplace_back(std::get<Vector3>(command.parameters()));
-			} break;
+				return false;
+			}
+			groupMeshes.push_back(mesh->mesh);
+			i = mesh->end;
+		}
+		else if (!isGeometry(op) && !(wholeBlock && (isTransform(op) || op == Command::Operation::OpenBrace || op == Command::Operation::CloseBrace)))
+		{
+			return false;
+		}
+	}
 
-			case Command::Operation::Vertex:
+	// Later instances still find the meshes it loads
+	for (auto& mesh : groupMeshes)
+	{
+		meshes[mesh->name] = mesh;
+	}
+	return true;
+}
+
+template <typename Call>
+void SimpEngine::submit(Call&& call)
+{
+	if (pipeline)
+	{
+		pipeline->submit(std::forward<Call>(call));
+	}
+	else
+	{
+		call(_renderEngine);
+	}
+}
+
+void SimpEngine::renderMesh(const std::shared_ptr<const Mesh>& mesh)
+{
+	auto modelViewMatrix = cameraCTMInv * CTM;
+	submit([mesh, modelViewMatrix, renderMode = currentRenderMode](RenderEngine& renderEngine)
+	{
+		renderEngine.RenderMesh(*mesh, modelViewMatrix, renderMode);
+	});
+}
+
+void SimpEngine::flushPolygons()
+{
+	if (polygonBatch.triangles.empty())
+	{
+		return;
+	}
+
+	submit([batch = std::move(polygonBatch), renderMode = currentRenderMode](RenderEngine& renderEngine)
+	{
+		renderEngine.RenderTriangles(batch, renderMode);
+	});
+	polygonBatch = TriangleBatch{};
+}
+
+void SimpEngine::flushLines()
+{
+	if (lineBatch.lines.empty())
+	{
+		return;
+	}
+
+	submit([batch = std::move(lineBatch)](RenderEngine& renderEngine)
+	{
+		renderEngine.RenderLines(batch);
+	});
+	lineBatch = LineBatch{};
+}
+
+void SimpEngine::flushBatches()
+{
+	flushPolygons();
+	flushLines();
+}
+
+template <typename CommandView>
+void SimpEngine::runCommand(const CommandView& command)
+{
+	// Anything else may change the transform or the settings a batch is drawn with
+	if (command.operation() != Command::Operation::Polygon)
+	{
+		flushPolygons();
+	}
+	if (command.operation() != Command::Operation::Line)
+	{
+		flushLines();
+	}
+
+	switch (command.operation())
+	{
+		case Command::Operation::Filled:
+		{
+			currentRenderMode = RenderEngine::RenderMode::Filled;
+		} break;
+
+		case Command::Operation::Wire:
+		{
+			currentRenderMode = RenderEngine::RenderMode::Wireframe;
+		} break;
+
+		case Command::Operation::Aliased:
+		{
+			submit([](RenderEngine& renderEngine) { renderEngine.SetLineMode(RenderEngine::LineMode::Aliased); });
+		} break;
+
+		case Command::Operation::Antialiased:
+		{
+			submit([](RenderEngine& renderEngine) { renderEngine.SetLineMode(RenderEngine::LineMode::Antialiased); });
+		} break;
+
+		case Command::Operation::OpenBrace:
+		{
+			TransformStack.push(CTM);
+
+		} break;
+
+		case Command::Operation::CloseBrace:
+		{
+			if (!TransformStack.empty())
 			{
-				Vertex v;
-				v.location = std::get<Point4D>(command.parameters());
-				v.location = this->CTM * v.location;
-				v.location = this->cameraCTMInv * v.location;
+				CTM = std::move(TransformStack.top());
+				TransformStack.pop();
+			}
+		} break;
 
-				vertices.push_back(v);
-			} break;
+		case Command::Operation::Scale:
+		case Command::Operation::Rotate:
+		case Command::Operation::Translate:
+		{
+			auto transform = SceneGraph::transformOf(command);
+			CTM = CTM * transform;
+		} break;
 
-			case Command::Operation::Face:
+		case Command::Operation::Line:
+		{
+			auto params = command.template get<LineParams>();
+			auto line = std::array<std::uint32_t, 2>{};
+			for (auto i = 0u; i < params.size(); ++i)
+			{
+				auto point = std::array<double, 4>{ params[i].x, params[i].y, params[i].z, 1 };
+				auto transformedPoint = cameraCTMInv * (CTM * point);
+				line[i] = addBatchVertex(lineBatch, Point4D{ transformedPoint, params[i].color });
+			}
+
+			// Drawn with the lines around it, once something else comes along
+			lineBatch.lines.push_back(line);
+			if (lineBatch.lines.size() == BatchSize)
 			{
-				FaceParam params = std::get<FaceParam>(command.parameters());
-				std::vector<Vertex*> faceVertices;
-				faceVertices.reserve(params.size());
+				flushLines();
+			}
+		} break;
 
-				std::vector<int> vertexIndices;
-				vertexIndices.reserve(params.size());
-				std::for_each(params.begin(), params.end(), [this, &faceVertices, &vertexIndices](auto& vertex)
-				{
-					// Vertex
-					Vertex* v;
-					std::size_t index;
-					if (vertex[0] > 0)
-					{
-						index = vertex[0] - 1;
-					}
-					else
-					{
-						index = this->vertices.size() + vertex[0];
-					}
-
-					v = &this->vertices.at(index);
-					faceVertices.push_back(v);
-					vertexIndices.push_back(static_cast<int>(index));
-
-					// Normal
-					if (vertex[2] != 0)
-					{
-						Point normal;
-						if (vertex[2] > 0)
-						{
-							normal = this->normals.at(vertex[2] - 1);
-						}
-						else
-						{
-							normal = this->normals.at(this->normals.size() + vertex[2]);
-						}
-						v->assignedNormal = normal;
-					}
-
-					return v;
-				});
-
-				//auto thesholdInRadian = getRadianFromDegree(45);
-				//auto cosThreshold = std::cos(thesholdInRadian);
-
-				if (faceVertices.size() > 3)
-				{
-					Face tempFace;
-					tempFace.vertices = faceVertices;
-					tempFace.vertexIndices = vertexIndices;
-					auto normal = tempFace.getFaceNormal();
-					for (auto v : tempFace.vertices)
-					{
-						/*if (v->faceNormals.size() > 0)
-						{
-							if (std::any_of(v->faceNormals.begin(), v->faceNormals.end(), [cosThreshold, &normal](auto& n) { return dot(normal, n) < cosThreshold; }))
-							{
-								v->faceNormals.push_back(normal);
-							}
-						}
-						else
-						{*/
-							v->faceNormals.push_back(normal);
-						//}
-					}
-					
-					for (auto i = 1u; i < faceVertices.size() - 1; ++i)
-					{
-						Face face;
-						face.vertices.push_back(faceVertices[0]);
-						face.vertices.push_back(faceVertices[i]);
-						face.vertices.push_back(faceVertices[i + 1]);
-					
-						face.vertexIndices.push_back(vertexIndices[0]);
-						face.vertexIndices.push_back(vertexIndices[i]);
-						face.vertexIndices.push_back(vertexIndices[i + 1]);
-
-						face.normal = normal;
-						faces.push_back(face);
-						//_renderEngine.RenderTriangle(triangle, currentRenderMode);
-					}
+		case Command::Operation::Polygon:
+		{
+			auto params = command.template get<PolygonParams>();
+			auto triangle = std::array<std::uint32_t, 3>{};
+			for (auto i = 0u; i < params.size(); ++i)
+			{
+				auto point = std::array<double, 4>{ params[i].x, params[i].y, params[i].z, 1 };
+				auto transformedPoint = cameraCTMInv * (CTM * point);
+				triangle[i] = addBatchVertex(polygonBatch, Point4D{ transformedPoint, params[i].color });
+			}
+
+			// Drawn with the polygons around it, once something else comes along
+			polygonBatch.triangles.push_back(triangle);
+			if (polygonBatch.triangles.size() == BatchSize)
+			{
+				flushPolygons();
+			}
+		} break;
 
-				}
-				else
+		case Command::Operation::Ambient:
+		{
+			auto color = command.template get<Color>();
+			submit([color](RenderEngine& renderEngine) { renderEngine.SetAmbientColor(color); });
+		} break;
+
+		case Command::Operation::Camera:
+		{
+			auto camera = SceneGraph::cameraFrom(CTM, command.template get<CameraParams>());
+			cameraCTMInv = camera.transformationMatrix;
+			// A redraw of part of the screen keeps what is already there
+			submit([camera, clearDepth = !redrawing](RenderEngine& renderEngine)
+			{
+				renderEngine.SetCamera(camera);
+				if (clearDepth)
 				{
-					Face face;
-					face.vertices = faceVertices;
-					face.vertexIndices = vertexIndices;
-					auto normal = face.getFaceNormal();
-					for (auto v : face.vertices)
-					{
-						v->faceNormals.push_back(normal);
-					}
-					face.normal = normal;
-
-					faces.push_back(face);
-					//_renderEngine.RenderTriangle(faceVertices, currentRenderMode);
+					renderEngine.ClearDepthBuffer();
 				}
+			});
+		} break;
 
-			} break;
+		case Command::Operation::Depth:
+		{
+			auto params = command.template get<DepthParams>();
+			submit([depth = Depth{ params.near, params.far, params.color }](RenderEngine& renderEngine) { renderEngine.SetDepth(depth); });
+		} break;
 
-			case Command::Operation::ObjectFile:
+		case Command::Operation::VertexNormal:
+		{
+			if (!meshBuilders.empty())
 			{
-				if (std::get<std::string>(command.parameters()) == "ENDOFOBJECTFILE"s)
-				{
-					// Draw all the faces
-					for (auto& f : faces)
-					{
-						f.vertices.clear();
-						for (auto i : f.vertexIndices)
-						{
-							f.vertices.push_back(&vertices[i]);
-						}
-						_renderEngine.RenderFace(f, currentRenderMode);
-					}
-
-					if (!objFileVerticesStack.empty())
-					{
-						vertices = objFileVerticesStack.top();
-						objFileVerticesStack.pop();
-					}
-
-					if (!objFileNormalsStack.empty())
-					{
-						normals = objFileNormalsStack.top();
-						objFileNormalsStack.pop();
-					}
-
-					if (!objFileFacesStack.empty())
-					{
-						faces = objFileFacesStack.top();
-						objFileFacesStack.pop();
-					}
-				}
-				else
-				{
-					objFileVerticesStack.push(vertices);
-					vertices.clear();
+				meshBuilders.top().addNormal(command.template get<Vector3>());
+			}
+		} break;
 
-					objFileNormalsStack.push(normals);
-					normals.clear();
+		case Command::Operation::Vertex:
+		{
+			// Kept in object space, the model transform is applied when the mesh is drawn
+			if (!meshBuilders.empty())
+			{
+				meshBuilders.top().addVertex(command.template get<Point4D>());
+			}
+		} break;
 
-					objFileFacesStack.push(faces);
-					faces.clear();
-				}
-			} break;
+		case Command::Operation::Face:
+		{
+			if (!meshBuilders.empty())
+			{
+				meshBuilders.top().addFace(command.template get<FaceParam>());
+			}
+		} break;
 
-			case Command::Operation::Surface:
+		case Command::Operation::ObjectFile:
+		{
+			if (command.template get<std::string>() == "ENDOFOBJECTFILE"s)
 			{
-				auto params = std::get<SurfaceParams>(command.parameters());
-				_renderEngine.SetSpecularCoefficient(params[0]);
-				_renderEngine.SetSpecularExponent(params[1]);
-			} break;
+				if (!meshBuilders.empty())
+				{
+					auto mesh = std::make_shared<const Mesh>(meshBuilders.top().build());
+					meshBuilders.pop();
 
-			case Command::Operation::Light:
+					// Draw the mesh, then keep it around for instancing
+					renderMesh(mesh);
+					meshes[mesh->name] = mesh;
+				}
+			}
+			else
 			{
-				auto params = std::get<LightParams>(command.parameters());
-				auto lightColor = Color::getDenormalizedColor(params[0], params[1], params[2]);
-				auto lightPosition = CTM * Vector4_t{ 0, 0, 0, 1 };
-				lightPosition = cameraCTMInv * lightPosition;
-				auto light = Light{ lightPosition, lightColor, params[3], params[4] };
-				_renderEngine.AddLight(light);
-			} break;
+				meshBuilders.emplace(command.template get<std::string>(), creaseAngle);
+			}
+		} break;
 
-			case Command::Operation::Phong:
-			case Command::Operation::Gouraud:
-			case Command::Operation::Flat:
+		case Command::Operation::Instance:
+		{
+			const auto& meshName = command.template get<std::string>();
+			auto mesh = meshes.find(meshName);
+			if (mesh == meshes.end())
 			{
-				_renderEngine.SetLightingMethod(std::get<LightingMethod>(command.parameters()));
-			} break;
-		}
-	}
-}
+				throw std::invalid_argument("Cannot instance a mesh that was not loaded");
+			}
 
-CTM_t SimpEngine::getRotationMatrix(const Axis& axis, int degree) const
-{
-	auto radian = -getRadianFromDegree(degree);
-	switch (axis)
-	{
-		case Axis::X:
+			renderMesh(mesh->second);
+		} break;
+
+		case Command::Operation::Surface:
+		{
+			auto params = command.template get<SurfaceParams>();
+			submit([params](RenderEngine& renderEngine)
+			{
+				renderEngine.SetSpecularCoefficient(params[0]);
+				renderEngine.SetSpecularExponent(params[1]);
+			});
+		} break;
+
+		case Command::Operation::Crease:
+		{
+			creaseAngle = command.template get<CreaseParams>();
+		} break;
+
+		case Command::Operation::Multisample:
 		{
-			return CTM_t{ 1.0, 0.0,				 0.0,				0.0,
-						  0.0, std::cos(radian), -std::sin(radian), 0.0,
-						  0.0, std::sin(radian), std::cos(radian),  0.0,
-						  0.0, 0.0,				 0.0,				1.0 };
+			auto sampleCount = command.template get<MultisampleParams>().sampleCount;
+			submit([sampleCount](RenderEngine& renderEngine) { renderEngine.SetMultisampling(sampleCount); });
 		} break;
 
-		case Axis::Y:
+		case Command::Operation::Light:
 		{
-			return CTM_t{ std::cos(radian),	 0.0, std::sin(radian), 0.0,
-						  0.0,				 1.0, 0.0,				0.0,
-						  -std::sin(radian), 0.0, std::cos(radian), 0.0,
-						  0.0,				 0.0, 0.0,				1.0 };
+			auto params = command.template get<LightParams>();
+			auto lightColor = Color::getDenormalizedColor(params[0], params[1], params[2]);
+			auto lightPosition = CTM * Vector4_t{ 0, 0, 0, 1 };
+			lightPosition = cameraCTMInv * lightPosition;
+			auto light = Light{ lightPosition, lightColor, params[3], params[4] };
+			submit([light](RenderEngine& renderEngine) { renderEngine.AddLight(light); });
 		} break;
 
-		case Axis::Z:
-		default:
+		case Command::Operation::Phong:
+		case Command::Operation::Gouraud:
+		case Command::Operation::Flat:
 		{
-			return CTM_t{ std::cos(radian), -std::sin(radian), 0.0, 0.0,
-						  std::sin(radian), std::cos(radian),  0.0, 0.0,
-						  0.0,				0.0,			   1.0, 0.0,
-						  0.0,				0.0,			   0.0, 1.0 };
+			auto method = command.template get<LightingMethod>();
+			submit([method](RenderEngine& renderEngine) { renderEngine.SetLightingMethod(method); });
+		} break;
+
+		// The file was read in when the scene was parsed, keys only drive animations
+		case Command::Operation::File:
+		case Command::Operation::Keyframe:
+		{
+
 		} break;
 	}
 }
\ No newline at end of file
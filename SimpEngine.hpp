@@ -1,23 +1,107 @@
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <stack>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "CommonTypeAliases.hpp"
 #include "command.hpp"
+#include "CommandStream.hpp"
 #include "RenderingEngine.hpp"
-#include "Vertex.hpp"
-#include "Face.hpp"
+#include "Mesh.hpp"
+#include "MeshBuilder.hpp"
+#include "RenderPipeline.hpp"
+#include "SceneGraph.hpp"
+#include "SimpFile.hpp"
 
 class SimpEngine
 {
 public:
 	SimpEngine(RenderEngine renderEngine) : _renderEngine(renderEngine) {}
 
-	void runCommands(const std::vector<Command>& commands);
+	void runCommands(const CommandStream& commands);
+
+	// Runs the commands of a file while its includes are still loading, it
+	// only waits when it gets to an include that is not ready
+	void runFile(const SimpFile& file);
+
+	// Interprets and transforms on this thread while rasterThreads workers
+	// light and rasterize, each into its own band of the viewport. The result
+	// is the same as runCommands, 0 threads means one per core
+	void runCommandsPipelined(const CommandStream& commands, int rasterThreads = 0);
+
+	// Retained mode: the commands are kept after they are drawn, so one can be
+	// replaced and only the screen area its block covered is drawn again
+	void retainCommands(const CommandStream& commands);
+
+	void replaceCommand(std::size_t index, const Command& command);
+
+	// Redraws the old and new screen area of every block changed since the last call
+	void renderChanges(unsigned int backgroundColor = 0x00000000);
+
+	// Redraws the whole retained scene from camera without interpreting it again,
+	// geometry and lights stay in world space and only the view changes
+	void renderView(const Camera& camera, unsigned int backgroundColor = 0x00000000);
+
+	// The camera the retained scene places last, empty when it has none
+	std::optional<Camera> sceneCamera();
 private:
+	// A brace block, or a single command outside of any block
+	struct RetainedGroup
+	{
+		std::size_t begin;
+		std::size_t end;
+		std::optional<Rect> bounds;
+		bool dirty;
+	};
+
+	// Takes a Command or a CommandStream::View, a view decodes only the params it needs
+	template <typename CommandView>
+	void runCommand(const CommandView& command);
+
+	// Runs a call on the engine right away, or hands it to the raster workers
+	template <typename Call>
+	void submit(Call&& call);
+
+	void renderMesh(const std::shared_ptr<const Mesh>& mesh);
 
-	CTM_t getRotationMatrix(const Axis& axis, int degree) const;
+	// Draw what was batched so far, before anything can change its state
+	void flushPolygons();
+	void flushLines();
+	void flushBatches();
+
+	// Waits for the raster workers, takes their settings back and drops them
+	void endPipeline();
+
+	// Splits retainedCommands[begin, end) into groups that can be redrawn on their own
+	void groupCommands(std::size_t begin, std::size_t end);
+
+	// A mesh a retained obj include built, with what it was built from
+	struct RetainedMesh
+	{
+		// The command that ends the include
+		std::size_t end;
+		int creaseAngle;
+		std::shared_ptr<const Mesh> mesh;
+	};
+
+	void resetInterpreter();
+
+	void runGroup(RetainedGroup& group);
+
+	// The mesh built from the obj include starting at index, if it can be used as it is
+	const RetainedMesh* retainedMesh(std::size_t index) const;
+
+	// An unchanged group away from the changes keeps its pixels and does not
+	// run again, unless it leaves state behind for the groups after it.
+	// Returns whether the group was skipped
+	bool skipGroup(const RetainedGroup& group);
+
+	// Built the first time a view is requested, dropped when a command changes
+	SceneGraph& retainedScene();
 
 	RenderEngine _renderEngine;
 	
@@ -36,12 +120,23 @@ private:
 
 	std::stack<CTM_t> TransformStack;
 
-	std::vector<Vertex> vertices;
-	std::stack<std::vector<Vertex>> objFileVerticesStack;
+	std::stack<MeshBuilder> meshBuilders;
+	int creaseAngle = 180;
+	// Shared with calls still waiting in the pipeline
+	std::unordered_map<std::string, std::shared_ptr<const Mesh>> meshes;
+
+	std::unique_ptr<RenderPipeline> pipeline;
 
-	std::vector<Face> faces;
-	std::stack<std::vector<Face>> objFileFacesStack;
+	// Consecutive polygons or lines, already in camera space
+	TriangleBatch polygonBatch;
+	LineBatch lineBatch;
 
-	std::vector<Point> normals;
-	std::stack<std::vector<Point>> objFileNormalsStack;
+	CommandStream retainedCommands;
+	std::vector<RetainedGroup> retainedGroups;
+	// By the index of the obj command starting them, kept across redraws
+	std::unordered_map<std::size_t, RetainedMesh> retainedMeshes;
+	std::optional<SceneGraph> sceneGraph;
+	// Render settings before the first command, restored for every redraw
+	std::optional<RenderEngine> initialSettings;
+	bool redrawing = false;
 };
\ No newline at end of file
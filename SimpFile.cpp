@@ -22,9 +22,70 @@ SimpFile::SimpFile(const std::string& fileName) : currentStream(fileName)
 	}
 }
 
-std::vector<Command> SimpFile::commands() const
+SimpFile::Include::Include(std::vector<std::string> tokens, const std::string& fileName) : tokens(std::move(tokens))
 {
-	return _commands;
+	loader.add("load " + fileName, [this, fileName]()
+	{
+		file = std::make_unique<SimpFile>(fileName);
+	});
+	loader.start(JobSystem::shared());
+}
+
+SimpFile::Include::~Include()
+{
+	// The job writes into this include, it has to be done before it goes away
+	try
+	{
+		loader.wait(JobSystem::shared());
+	}
+	catch (...)
+	{
+	}
+}
+
+CommandStream SimpFile::commands() const
+{
+	CommandStream result;
+	forEachCommand([&result](const Command& command) { result.push_back(command); });
+	return result;
+}
+
+void SimpFile::forEachCommand(const std::function<void(const Command&)>& visit) const
+{
+	ParseContext context;
+	forEachCommand(visit, context);
+}
+
+void SimpFile::forEachCommand(const std::function<void(const Command&)>& visit, ParseContext& context) const
+{
+	auto next = std::size_t{ 0 };
+	for (auto& [position, include] : includes)
+	{
+		for (; next < position; ++next)
+		{
+			visit(Command(lines[next], context));
+		}
+
+		include->loader.wait(JobSystem::shared());
+
+		// An obj stays wrapped in its own command and an end marker
+		Command command(include->tokens, context);
+		auto isObject = command.operation() == Command::Operation::ObjectFile;
+		if (isObject)
+		{
+			visit(command);
+		}
+		include->file->forEachCommand(visit, context);
+		if (isObject)
+		{
+			visit(Command{ Command::Operation::ObjectFile, "ENDOFOBJECTFILE"s });
+		}
+	}
+
+	for (; next < lines.size(); ++next)
+	{
+		visit(Command(lines[next], context));
+	}
 }
 
 std::vector<std::string> SimpFile::getTokens(const std::string& line)
@@ -67,31 +128,19 @@ std::vector<std::string> SimpFile::getTokens(const std::string& line)
 void SimpFile::parseAndAddLine(const std::string& line)
 {
 	auto tokens = getTokens(line);
-	if (tokens.size() > 0 && (OperationTokens.find(tokens[0]) != OperationTokens.end()))
+	auto op = tokens.size() > 0 ? Command::operationOf(tokens[0]) : std::nullopt;
+	if (op)
 	{
-		Command command(tokens);
-		if (command.operation() == Command::Operation::File ||
-			command.operation() == Command::Operation::ObjectFile)
+		if (op == Command::Operation::File || op == Command::Operation::ObjectFile)
 		{
-			auto fileName = std::get<std::string>(command.parameters());
-			
-			if (command.operation() == Command::Operation::ObjectFile)
-			{
-				_commands.push_back(command);
-			}
-			
-			SimpFile childFile(fileName);
-			auto childCommands = childFile.commands();
-			_commands.insert(_commands.end(), childCommands.begin(), childCommands.end());
-			
-			if (command.operation() == Command::Operation::ObjectFile)
-			{
-				_commands.push_back(Command{ Command::Operation::ObjectFile, "ENDOFOBJECTFILE"s });
-			}
+			// Naming a file does not depend on the context
+			ParseContext unused;
+			auto fileName = std::get<std::string>(Command(tokens, unused).parameters());
+			includes.emplace_back(lines.size(), std::make_shared<Include>(std::move(tokens), fileName));
 		}
 		else
 		{
-			_commands.push_back(command);
+			lines.push_back(std::move(tokens));
 		}
 
 	}
@@ -1,18 +1,52 @@
 #pragma once
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "command.hpp"
+#include "CommandStream.hpp"
+#include "JobSystem.hpp"
 
+// A SIMP file with its includes. Included files are read and split into
+// tokens on the job system as soon as they are found, including the ones they
+// include in turn, so a scene with many includes loads them concurrently.
+// Commands are built in file order since a surface line changes the color of
+// the vertices after it, even across includes.
 class SimpFile
 {
 public:
 	SimpFile(const std::string& fileName);
 
-	std::vector<Command> commands() const;
+	// Every command with the includes spliced in, waits for all of them
+	CommandStream commands() const;
+
+	// Visits the commands in order and only waits for an include once it is
+	// reached, so they can be run while later includes are still loading
+	void forEachCommand(const std::function<void(const Command&)>& visit) const;
 
 private:
+	// An include being loaded by one job
+	struct Include
+	{
+		Include(std::vector<std::string> tokens, const std::string& fileName);
+		~Include();
+
+		// The tokens of the file or obj line that named it
+		std::vector<std::string> tokens;
+		std::unique_ptr<SimpFile> file;
+		TaskGraph loader;
+	};
+
+	void forEachCommand(const std::function<void(const Command&)>& visit, ParseContext& context) const;
+
 	std::vector<std::string> getTokens(const std::string& line);
 	void parseAndAddLine(const std::string& line);
 
 	std::ifstream currentStream;
-	std::vector<Command> _commands;
-};
\ No newline at end of file
+	// The tokens of every command line but the includes
+	std::vector<std::vector<std::string>> lines;
+	// Includes with the number of lines that come before them
+	std::vector<std::pair<std::size_t, std::shared_ptr<Include>>> includes;
+};
@@ -0,0 +1,39 @@
+#include "SpecularTable.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+SpecularTable::SpecularTable(double exponent) : SpecularTable(exponent, intervalsFor(exponent))
+{
+}
+
+SpecularTable::SpecularTable(double exponent, int size) : _exponent(exponent), scale(static_cast<float>(size))
+{
+	if (size < 1)
+	{
+		throw std::invalid_argument("Specular table needs at least one interval");
+	}
+
+	// One extra sample so x = 1 has a right neighbour to interpolate with
+	samples.resize(size + 1);
+	for (auto i = 0; i <= size; ++i)
+	{
+		samples[i] = static_cast<float>(std::pow(static_cast<double>(i) / size, exponent));
+	}
+}
+
+// Linear interpolation of x^p is off by at most p(p - 1) h^2 / 8 for intervals
+// of width h, the curvature peaking at x = 1. Solving for a quarter of a color
+// step, leaving the other quarter to the float lookup, gives the count, kept
+// between 2048 and 2^24 intervals (64MB)
+int SpecularTable::intervalsFor(double exponent)
+{
+	const auto minimum = 2048.0;
+	const auto maximum = static_cast<double>(1 << 24);
+	const auto tolerance = 0.25 / 255.0;
+
+	auto curvature = std::abs(exponent * (exponent - 1.0));
+	auto intervals = std::ceil(std::sqrt(curvature / (8.0 * tolerance)));
+	return static_cast<int>(std::clamp(intervals, minimum, maximum));
+}
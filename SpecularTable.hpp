@@ -0,0 +1,43 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+// Samples x^exponent over [0, 1] so the specular term of the lighting is a
+// table read instead of a call to pow. Built once per specular exponent.
+class SpecularTable
+{
+public:
+	// Picks enough intervals that the table is off by under half a color step
+	explicit SpecularTable(double exponent);
+	SpecularTable(double exponent, int size);
+
+	// Linearly interpolates between the two nearest samples
+	float lookup(float x) const
+	{
+		if (x <= 0.0f)
+		{
+			return samples.front();
+		}
+		if (x >= 1.0f)
+		{
+			return samples.back();
+		}
+
+		auto position = x * scale;
+		auto index = std::min(static_cast<int>(position), static_cast<int>(samples.size()) - 2);
+		auto t = position - static_cast<float>(index);
+		return samples[index] + t * (samples[index + 1] - samples[index]);
+	}
+
+	double exponent() const
+	{
+		return _exponent;
+	}
+
+private:
+	static int intervalsFor(double exponent);
+
+	double _exponent;
+	float scale;
+	std::vector<float> samples;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free ring for one producer thread and one consumer thread.
+// The capacity is rounded up to a power of two. Head and tail only grow and
+// are masked on access, each is written by one side only.
+template <typename T>
+class SpscQueue
+{
+public:
+	explicit SpscQueue(std::size_t capacity)
+	{
+		auto size = std::size_t{ 1 };
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+		slots.resize(size);
+		mask = size - 1;
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// Moves value in, false when the ring is full
+	bool tryPush(T& value)
+	{
+		auto currentTail = tail.load(std::memory_order_relaxed);
+		if (currentTail - head.load(std::memory_order_acquire) == slots.size())
+		{
+			return false;
+		}
+		slots[currentTail & mask] = std::move(value);
+		tail.store(currentTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Moves the oldest value out, false when the ring is empty
+	bool tryPop(T& value)
+	{
+		auto currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead == tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		value = std::move(slots[currentHead & mask]);
+		head.store(currentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::vector<T> slots;
+	std::size_t mask;
+	// On separate cache lines so the two sides do not contend
+	alignas(64) std::atomic<std::size_t> head{ 0 };
+	alignas(64) std::atomic<std::size_t> tail{ 0 };
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "primitives.hpp"
+
+// Loose triangles in camera space, drawn together. A vertex several of them
+// share is stored once and indexed.
+struct TriangleBatch
+{
+	std::vector<Point4D> vertices;
+	std::vector<std::array<std::uint32_t, 3>> triangles;
+};
@@ -31,14 +31,14 @@ void assignment3::doNextPage(Client * client, const std::string& fileName)
 		SimpFile file(fileName);
 		RenderEngine renderer{ viewPort, client->getDrawable(), Color{255, 255, 255} };
 		SimpEngine simpEngine(renderer);
-		simpEngine.runCommands(file.commands());
+		simpEngine.runFile(file);
 	}
 	else
 	{
 		SimpFile file("test.simp");
 		RenderEngine renderer{ viewPort, client->getDrawable(), Color{ 255, 255, 255 } };
 		SimpEngine simpEngine(renderer);
-		simpEngine.runCommands(file.commands());
+		simpEngine.runFile(file);
 	}
 
 	client->getDrawable()->updateScreen();   // you must call this to make the display change.
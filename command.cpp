@@ -1,27 +1,107 @@
 #include "command.hpp"
 
-using namespace std::string_literals;
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
 
-static const std::unordered_map<std::string, Axis> AxisTokens{
-	{ "X"s, Axis::X },
-	{ "Y"s, Axis::Y },
-	{ "Z"s, Axis::Z }
-};
+using namespace std::string_view_literals;
 
-Command::Command(const std::vector<std::string>& tokens)
+static constexpr std::array<std::pair<std::string_view, Axis>, 3> AxisTokens{ {
+	{ "X"sv, Axis::X },
+	{ "Y"sv, Axis::Y },
+	{ "Z"sv, Axis::Z }
+} };
+
+// Sorted by keyword, a lookup is a binary search over a table built at compile time
+static constexpr std::array<std::pair<std::string_view, Command::Operation>, 28> OperationTokens{ {
+	{ "aliased"sv, Command::Operation::Aliased },
+	{ "ambient"sv, Command::Operation::Ambient },
+	{ "antialiased"sv, Command::Operation::Antialiased },
+	{ "camera"sv, Command::Operation::Camera },
+	{ "crease"sv, Command::Operation::Crease },
+	{ "depth"sv, Command::Operation::Depth },
+	{ "f"sv, Command::Operation::Face },
+	{ "file"sv, Command::Operation::File },
+	{ "filled"sv, Command::Operation::Filled },
+	{ "flat"sv, Command::Operation::Flat },
+	{ "gouraud"sv, Command::Operation::Gouraud },
+	{ "instance"sv, Command::Operation::Instance },
+	{ "key"sv, Command::Operation::Keyframe },
+	{ "light"sv, Command::Operation::Light },
+	{ "line"sv, Command::Operation::Line },
+	{ "msaa"sv, Command::Operation::Multisample },
+	{ "obj"sv, Command::Operation::ObjectFile },
+	{ "phong"sv, Command::Operation::Phong },
+	{ "polygon"sv, Command::Operation::Polygon },
+	{ "rotate"sv, Command::Operation::Rotate },
+	{ "scale"sv, Command::Operation::Scale },
+	{ "surface"sv, Command::Operation::Surface },
+	{ "translate"sv, Command::Operation::Translate },
+	{ "v"sv, Command::Operation::Vertex },
+	{ "vn"sv, Command::Operation::VertexNormal },
+	{ "wire"sv, Command::Operation::Wire },
+	{ "{"sv, Command::Operation::OpenBrace },
+	{ "}"sv, Command::Operation::CloseBrace }
+} };
+
+template <typename Table>
+static constexpr bool isSortedByKeyword(const Table& table)
 {
-	static Color defaultVertexColor = Color{ 255, 255, 255 };
+	for (std::size_t i = 1; i < table.size(); ++i)
+	{
+		if (!(table[i - 1].first < table[i].first))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+static_assert(isSortedByKeyword(OperationTokens), "OperationTokens has to stay sorted");
+static_assert(isSortedByKeyword(AxisTokens), "AxisTokens has to stay sorted");
+
+// Binary search of a keyword table
+template <typename Table>
+static auto findKeyword(const Table& table, std::string_view keyword) -> std::optional<typename Table::value_type::second_type>
+{
+	auto found = std::lower_bound(table.begin(), table.end(), keyword, [](const auto& entry, std::string_view key)
+	{
+		return entry.first < key;
+	});
+	if (found == table.end() || found->first != keyword)
+	{
+		return std::nullopt;
+	}
+	return found->second;
+}
+
+static Axis axisOf(const std::string& token)
+{
+	auto axis = findKeyword(AxisTokens, token);
+	if (!axis)
+	{
+		throw std::invalid_argument("Unknown axis " + token);
+	}
+	return *axis;
+}
 
-	_op = OperationTokens.at(tokens[0]);
+Command::Command(const std::vector<std::string>& tokens, ParseContext& context)
+{
+	auto op = operationOf(tokens[0]);
+	if (!op)
+	{
+		throw std::invalid_argument("Unknown command " + tokens[0]);
+	}
+	_op = *op;
 	switch (_op)
 	{
 		case Command::Operation::Polygon:
 		{
 			if (tokens.size() == 10)
 			{
-				params = PolygonParams{ Point4D{ std::atof(tokens[1].c_str()), std::atof(tokens[2].c_str()), std::atof(tokens[3].c_str()), 1, defaultVertexColor },
-										Point4D{ std::atof(tokens[4].c_str()), std::atof(tokens[5].c_str()), std::atof(tokens[6].c_str()), 1, defaultVertexColor },
-										Point4D{ std::atof(tokens[7].c_str()), std::atof(tokens[8].c_str()), std::atof(tokens[9].c_str()), 1, defaultVertexColor } };
+				params = PolygonParams{ Point4D{ std::atof(tokens[1].c_str()), std::atof(tokens[2].c_str()), std::atof(tokens[3].c_str()), 1, context.defaultVertexColor },
+										Point4D{ std::atof(tokens[4].c_str()), std::atof(tokens[5].c_str()), std::atof(tokens[6].c_str()), 1, context.defaultVertexColor },
+										Point4D{ std::atof(tokens[7].c_str()), std::atof(tokens[8].c_str()), std::atof(tokens[9].c_str()), 1, context.defaultVertexColor } };
 			}
 			else
 			{
@@ -39,8 +119,8 @@ Command::Command(const std::vector<std::string>& tokens)
 			// no color
 			if (tokens.size() == 7)
 			{
-				params = LineParams{ Point4D{ std::atof(tokens[1].c_str()), std::atof(tokens[2].c_str()), std::atof(tokens[3].c_str()), 1, defaultVertexColor },
-									 Point4D{ std::atof(tokens[4].c_str()), std::atof(tokens[5].c_str()), std::atof(tokens[6].c_str()), 1, defaultVertexColor } };
+				params = LineParams{ Point4D{ std::atof(tokens[1].c_str()), std::atof(tokens[2].c_str()), std::atof(tokens[3].c_str()), 1, context.defaultVertexColor },
+									 Point4D{ std::atof(tokens[4].c_str()), std::atof(tokens[5].c_str()), std::atof(tokens[6].c_str()), 1, context.defaultVertexColor } };
 			}
 			else
 			{
@@ -61,7 +141,7 @@ Command::Command(const std::vector<std::string>& tokens)
 
 		case Command::Operation::Rotate:
 		{
-			params = RotateParams{ AxisTokens.at(tokens[1]), std::atoi(tokens[2].c_str()) };
+			params = RotateParams{ axisOf(tokens[1]), std::stod(tokens[2]) };
 		} break;
 
 		case Command::Operation::File:
@@ -72,6 +152,7 @@ Command::Command(const std::vector<std::string>& tokens)
 		} break;
 
 		case Command::Operation::ObjectFile:
+		case Command::Operation::Instance:
 		{
 			auto fileName = std::string(std::next(tokens[1].cbegin()), std::prev(tokens[1].cend()));
 			fileName += ".obj";
@@ -102,7 +183,7 @@ Command::Command(const std::vector<std::string>& tokens)
 
 		case Command::Operation::Surface:
 		{
-			defaultVertexColor = Color::getDenormalizedColor(std::atof(tokens[1].c_str()), std::atof(tokens[2].c_str()), std::atof(tokens[3].c_str()));
+			context.defaultVertexColor = Color::getDenormalizedColor(std::atof(tokens[1].c_str()), std::atof(tokens[2].c_str()), std::atof(tokens[3].c_str()));
 			if (tokens.size() > 4)
 			{
 				params = SurfaceParams{ std::atof(tokens[4].c_str()), std::atof(tokens[5].c_str()) };
@@ -131,12 +212,12 @@ Command::Command(const std::vector<std::string>& tokens)
 			// v x y z w
 			else if (tokens.size() == 5)
 			{
-				params = Point4D{ std::atof(tokens[1].c_str()), std::atof(tokens[2].c_str()), std::atof(tokens[3].c_str()), std::atof(tokens[4].c_str()), defaultVertexColor };
+				params = Point4D{ std::atof(tokens[1].c_str()), std::atof(tokens[2].c_str()), std::atof(tokens[3].c_str()), std::atof(tokens[4].c_str()), context.defaultVertexColor };
 			}
 			// v x y z
 			else
 			{
-				params = Point4D{ std::atof(tokens[1].c_str()), std::atof(tokens[2].c_str()), std::atof(tokens[3].c_str()), 1, defaultVertexColor };
+				params = Point4D{ std::atof(tokens[1].c_str()), std::atof(tokens[2].c_str()), std::atof(tokens[3].c_str()), 1, context.defaultVertexColor };
 			}
 		} break;
 
@@ -200,6 +281,23 @@ Command::Command(const std::vector<std::string>& tokens)
 								  std::atof(tokens[5].c_str()) };	// B attentuation
 		} break;
 
+		case Command::Operation::Crease:
+		{
+			params = CreaseParams{ std::atoi(tokens[1].c_str()) };
+		} break;
+
+		case Command::Operation::Multisample:
+		{
+			params = MultisampleParams{ std::atoi(tokens[1].c_str()) };
+		} break;
+
+		case Command::Operation::Keyframe:
+		{
+			auto values = std::vector<double>{};
+			std::transform(tokens.begin() + 2, tokens.end(), std::back_inserter(values), [](auto& token) { return std::atof(token.c_str()); });
+			params = KeyframeParams{ std::atof(tokens[1].c_str()), values };
+		} break;
+
 		case Command::Operation::Phong:
 		{
 			params = LightingMethod::Phong;
@@ -230,4 +328,9 @@ Command::Operation Command::operation() const
 const CommandParams& Command::parameters() const
 {
 	return params;
-}
\ No newline at end of file
+}
+
+std::optional<Command::Operation> Command::operationOf(const std::string& token)
+{
+	return findKeyword(OperationTokens, token);
+}
@@ -3,7 +3,9 @@
 #include <string>
 #include <utility>
 #include <array>
+#include <optional>
 #include <variant>
+#include <vector>
 #include <cstdlib>
 
 #include "primitives.hpp"
@@ -32,16 +34,36 @@ struct DepthParams
 	Color color;
 };
 
+struct MultisampleParams
+{
+	int sampleCount;
+};
+
+// Values of the transform or camera before it, reached at frame
+struct KeyframeParams
+{
+	double frame;
+	std::vector<double> values;
+};
+
 using Vector3 = std::array<double, 3>;
 using PolygonParams = std::array<Point4D, 3>;
 using LineParams = std::array<Point4D, 2>;
-using RotateParams = std::pair<Axis, int>;
+using RotateParams = std::pair<Axis, double>;
 using FileParam = std::string;
 using VertexParam = std::array<int, 3>;
 using FaceParam = std::vector<VertexParam>;
 using LightParams = std::array<double, 5>;
 using SurfaceParams = std::array<double, 2>;
-using CommandParams = std::variant<Vector3, PolygonParams, LineParams, RotateParams, FileParam, Color, CameraParams, DepthParams, Point4D, FaceParam, LightParams, LightingMethod, SurfaceParams>;
+using CreaseParams = int;
+using CommandParams = std::variant<Vector3, PolygonParams, LineParams, RotateParams, FileParam, Color, CameraParams, DepthParams, Point4D, FaceParam, LightParams, LightingMethod, SurfaceParams, CreaseParams, MultisampleParams, KeyframeParams>;
+
+// What a parse carries from one line to the next. Each parse owns its own,
+// so any number of files can be parsed at the same time
+struct ParseContext
+{
+	Color defaultVertexColor = Color{ 255, 255, 255 };
+};
 
 class Command
 {
@@ -60,55 +82,47 @@ public:
 		Filled,
 		Camera,
 		ObjectFile,
+		Instance,
 		Ambient,
 		Depth,
 		Surface,
+		Crease,
 		Vertex,
 		VertexNormal,
 		Face,
 		Light,
 		Phong,
 		Gouraud,
-		Flat
+		Flat,
+		Aliased,
+		Antialiased,
+		Multisample,
+		Keyframe
 	};
 
 
 	Command(Operation op, CommandParams&& parameters) : _op(op), params(parameters) {}
 
-	Command(const std::vector<std::string>& tokens);
+	// A surface line changes the default vertex color of the lines parsed after it
+	Command(const std::vector<std::string>& tokens, ParseContext& context);
+
+	// The operation a line starting with token names, empty if it is not a command
+	static std::optional<Operation> operationOf(const std::string& token);
 
 	Operation operation() const;
 
 	const CommandParams& parameters() const;
 
+	// The params as the CommandParams alternative T
+	template <typename T>
+	const T& get() const
+	{
+		return std::get<T>(params);
+	}
+
 private:
 	Operation _op;
 	CommandParams params;
 };
 
 using namespace std::string_literals;
-
-static const std::unordered_map<std::string, Command::Operation> OperationTokens{
-	{ "{"s, Command::Operation::OpenBrace },
-	{ "}"s, Command::Operation::CloseBrace },
-	{ "scale"s, Command::Operation::Scale },
-	{ "rotate"s, Command::Operation::Rotate },
-	{ "translate"s, Command::Operation::Translate },
-	{ "line"s, Command::Operation::Line },
-	{ "polygon"s, Command::Operation::Polygon },
-	{ "file"s, Command::Operation::File },
-	{ "wire"s, Command::Operation::Wire },
-	{ "filled"s, Command::Operation::Filled },
-	{ "camera"s, Command::Operation::Camera },
-	{ "obj"s, Command::Operation::ObjectFile },
-	{ "ambient"s, Command::Operation::Ambient },
-	{ "depth"s, Command::Operation::Depth },
-	{ "surface"s, Command::Operation::Surface },
-	{ "v"s, Command::Operation::Vertex },
-	{ "vn"s, Command::Operation::VertexNormal },
-	{ "f"s, Command::Operation::Face },
-	{ "light"s, Command::Operation::Light },
-	{ "phong"s, Command::Operation::Phong },
-	{ "gouraud"s, Command::Operation::Gouraud },
-	{ "flat"s, Command::Operation::Flat }
-};
\ No newline at end of file
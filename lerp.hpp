@@ -1,6 +1,10 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
 #include <vector>
 #include <utility>
 
@@ -54,3 +58,162 @@ private:
 	double start2;
 };
 
+// Interpolates N channels over a fixed number of steps by forward
+// differencing: advancing is one add per channel, with no range checks.
+// Callers step it exactly as many times as they asked for.
+template <typename T, std::size_t N>
+class IncrementalLerp
+{
+public:
+	using values_t = std::array<T, N>;
+
+	IncrementalLerp(const values_t& begin, const values_t& end, int steps) : current(begin)
+	{
+		for (auto i = 0u; i < N; ++i)
+		{
+			delta[i] = steps != 0 ? (end[i] - begin[i]) / static_cast<T>(steps) : T{ 0 };
+		}
+	}
+
+	const values_t& value() const
+	{
+		return current;
+	}
+
+	T operator[](std::size_t channel) const
+	{
+		return current[channel];
+	}
+
+	void advance()
+	{
+		for (auto i = 0u; i < N; ++i)
+		{
+			current[i] += delta[i];
+		}
+	}
+
+private:
+	values_t current;
+	values_t delta{};
+};
+
+// Evaluates begin + i * delta afresh at every step instead of accumulating
+// the delta, so the error does not grow with the number of steps and values
+// have no range to stay within. One multiply-add per channel and step.
+template <std::size_t N>
+class SteppedLerp
+{
+public:
+	using values_t = std::array<double, N>;
+
+	// steps is a double so lines far longer than an int can count are fine
+	SteppedLerp(const values_t& begin, const values_t& end, double steps) : begin(begin), current(begin)
+	{
+		for (auto i = 0u; i < N; ++i)
+		{
+			delta[i] = steps != 0 ? (end[i] - begin[i]) / steps : 0.0;
+		}
+	}
+
+	double operator[](std::size_t channel) const
+	{
+		return current[channel];
+	}
+
+	const values_t& value() const
+	{
+		return current;
+	}
+
+	void advance()
+	{
+		advanceTo(step + 1);
+	}
+
+	// Jumps to a step, the values are the same as if it had been walked to
+	void advanceTo(double target)
+	{
+		step = target;
+		for (auto i = 0u; i < N; ++i)
+		{
+			current[i] = begin[i] + step * delta[i];
+		}
+	}
+
+private:
+	values_t begin;
+	values_t current;
+	values_t delta;
+	double step = 0.0;
+};
+
+// Same walk in 32.32 fixed point, so the error does not grow with the
+// number of steps taken. Channels and the step between them must stay
+// within +-2^31, the constructor throws std::out_of_range otherwise, callers
+// clip to keep them there.
+template <std::size_t N>
+class FixedPointLerp
+{
+public:
+	using values_t = std::array<double, N>;
+
+	static constexpr double limit = 2147483647.0;
+
+	static bool inRange(double value)
+	{
+		return std::abs(value) < limit;
+	}
+
+	FixedPointLerp(const values_t& begin, const values_t& end, int steps)
+	{
+		for (auto i = 0u; i < N; ++i)
+		{
+			// The per step delta can be up to twice a channel's range
+			auto step = steps != 0 ? (end[i] - begin[i]) / steps : 0.0;
+			if (!inRange(begin[i]) || !inRange(end[i]) || !inRange(step))
+			{
+				throw std::out_of_range("Fixed point lerp channel out of range");
+			}
+
+			current[i] = toFixed(begin[i]);
+			delta[i] = toFixed(step);
+		}
+	}
+
+	double operator[](std::size_t channel) const
+	{
+		return static_cast<double>(current[channel]) / one;
+	}
+
+	// Integer part of the channel, rounded down
+	int whole(std::size_t channel) const
+	{
+		return static_cast<int>(current[channel] >> 32);
+	}
+
+	// Distance of the channel past its integer part, in [0, 1)
+	double fraction(std::size_t channel) const
+	{
+		return static_cast<double>(current[channel] & 0xffffffff) / one;
+	}
+
+	void advance()
+	{
+		for (auto i = 0u; i < N; ++i)
+		{
+			current[i] += delta[i];
+		}
+	}
+
+private:
+	static constexpr double one = 4294967296.0;
+
+	static std::int64_t toFixed(double value)
+	{
+		return static_cast<std::int64_t>(std::llround(value * one));
+	}
+
+	std::array<std::int64_t, N> current;
+	std::array<std::int64_t, N> delta;
+};
@@ -1,5 +1,8 @@
 #include "primitives.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+
 Line::Line(Point inp1, Point inp2, unsigned int c) : p1(inp1), p2(inp2), color(c)
 {
 	p1.color = Color(color);
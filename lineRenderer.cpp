@@ -1,5 +1,6 @@
 #include "lineRenderer.hpp"
 
+#include <array>
 #include <cmath>
 #include <utility>
 
@@ -404,4 +405,63 @@ void DDALineRenderer(const Point& p1, const Point& p2, Drawable* drawSurface, do
 			}
 		}
 	}
-}
\ No newline at end of file
+}
+
+void WuLineRenderer(const Point& p1, const Point& p2, Drawable* drawSurface, double opacity, Matrix2D<int>* zBuffer, const Rect* viewPort)
+{
+	auto octant = getOctant(p2 - p1);
+	auto point1 = toFirstOctant(octant, p1);
+	auto point2 = toFirstOctant(octant, p2);
+
+	auto x1 = static_cast<int>(std::round(point1.x));
+	auto x2 = static_cast<int>(std::round(point2.x));
+	auto steps = x2 - x1;
+
+	auto c1 = point1.color.getColorChannels();
+	auto c2 = point2.color.getColorChannels();
+
+	// y is stepped in fixed point, its fractional part is the coverage of the pixel below
+	FixedPointLerp<2> positionLerp({ point1.y, point1.z }, { point2.y, point2.z }, steps);
+	IncrementalLerp<double, 3> colorLerp({ double(std::get<0>(c1)), double(std::get<1>(c1)), double(std::get<2>(c1)) },
+										 { double(std::get<0>(c2)), double(std::get<1>(c2)), double(std::get<2>(c2)) }, steps);
+
+	for (auto x = x1; x <= x2; ++x)
+	{
+		auto y = positionLerp.whole(0);
+		auto coverage = positionLerp.fraction(0);
+		auto z = static_cast<int>(std::round(positionLerp[1]));
+		auto& channels = colorLerp.value();
+		auto newColor = Color{ static_cast<unsigned char>(std::round(channels[0])),
+							   static_cast<unsigned char>(std::round(channels[1])),
+							   static_cast<unsigned char>(std::round(channels[2])) };
+
+		std::array<std::pair<int, double>, 2> pixels{ std::make_pair(y, 1.0 - coverage), std::make_pair(y + 1, coverage) };
+		for (auto& pixel : pixels)
+		{
+			if (pixel.second <= 0.0)
+			{
+				continue;
+			}
+
+			auto screenPoint = fromFirstOctant(octant, Point{ x, pixel.first, z });
+			if (viewPort && !pointInRect(screenPoint, *viewPort))
+			{
+				continue;
+			}
+
+			auto oldColor = getCurrentColor(screenPoint.x, screenPoint.y, drawSurface);
+			auto colorToPaint = colorWithOpacity(newColor, oldColor, opacity * pixel.second);
+			if (viewPort)
+			{
+				drawPixel(screenPoint, drawSurface, colorToPaint, zBuffer, viewPort);
+			}
+			else
+			{
+				drawPixel(screenPoint, drawSurface, colorToPaint, zBuffer);
+			}
+		}
+
+		positionLerp.advance();
+		colorLerp.advance();
+	}
+}
@@ -9,6 +9,9 @@ void BresenhamLineRenderer(const Point& p1, const Point& p2, Drawable* drawSurfa
 
 void DDALineRenderer(const Point& p1, const Point& p2, Drawable* drawSurface, double opacity = 1.0, Matrix2D<int>* zBuffer = nullptr, const Rect* viewPort = nullptr);
 
+// Anti-aliased, coverage of the two pixels straddling the line scales the opacity
+void WuLineRenderer(const Point& p1, const Point& p2, Drawable* drawSurface, double opacity = 1.0, Matrix2D<int>* zBuffer = nullptr, const Rect* viewPort = nullptr);
+
 template <typename F>
 void renderLine(const Point& p1, const Point& p2, Drawable* surface, F function, Matrix2D<int>* zBuffer = nullptr)
 {
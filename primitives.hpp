@@ -7,6 +7,7 @@
 #include <numeric>
 
 #include "Color.hpp"
+#include "FloatColor.hpp"
 
 template <typename T>
 using Matrix2D = std::vector<std::vector<T>>;
@@ -40,11 +41,11 @@ Point operator/(const Point& p, double s);
 
 struct Point4D
 {
-	Point4D() : x(0), y(0), z(0), w(0), color(0xffffffff) {}
-	Point4D(const std::array<double, 4>& vector, const Color& color) : x(vector[0]), y(vector[1]), z(vector[2]), w(vector[3]), color(color) {}
-	Point4D(double x, double y, double z, double w, const Color& color) : x(x), y(y), z(z), w(w), color(color) {}
-	Point4D(double x, double y, double z, double w, const Color& color, const Point& normal) : x(x), y(y), z(z), w(w), color(color), normal(normal) {}
-	Point4D(double x, double y, double z, double w) : x(x), y(y), z(z), w(w), color(0xffffffff) {}
+	Point4D() : x(0), y(0), z(0), w(0), color(1.0f, 1.0f, 1.0f) {}
+	Point4D(const std::array<double, 4>& vector, const FloatColor& color) : x(vector[0]), y(vector[1]), z(vector[2]), w(vector[3]), color(color) {}
+	Point4D(double x, double y, double z, double w, const FloatColor& color) : x(x), y(y), z(z), w(w), color(color) {}
+	Point4D(double x, double y, double z, double w, const FloatColor& color, const Point& normal) : x(x), y(y), z(z), w(w), color(color), normal(normal) {}
+	Point4D(double x, double y, double z, double w) : x(x), y(y), z(z), w(w), color(1.0f, 1.0f, 1.0f) {}
 	Point4D(const Point& p) : x(p.x), y(p.y), z(p.z), w(1.0), color(p.color) {}
 
 	Point4D& operator=(const Point4D& other)
@@ -68,7 +69,7 @@ struct Point4D
 	double y;
 	double z;
 	double w;
-	Color color;
+	FloatColor color;
 	std::optional<Point> normal = std::nullopt;
 	std::optional<Point> cameraSpacePoint = std::nullopt;
 };
@@ -96,10 +97,15 @@ struct Rect
 	Point center() const;
 };
 
+// Smallest rect holding both
+Rect unite(const Rect& a, const Rect& b);
+// Empty when the rects do not overlap
+std::optional<Rect> intersect(const Rect& a, const Rect& b);
+
 
 Point operator+(const Point& p1, const Point& p2);
 Point operator-(const Point& p1, const Point& p2);
-double getRadianFromDegree(int angle);
+double getRadianFromDegree(double angle);
 
 struct Line
 {
@@ -160,10 +166,11 @@ enum class LightingMethod
 };
 
 
-template <typename T>
-T getCenterPoint(const std::vector<T>& points)
+template <typename Container>
+auto getCenterPoint(const Container& points)
 {
-	auto centerPoint = std::accumulate(points.begin(), points.end(), T{ 0.0, 0.0, 0.0, 1.0, 0xffffffff });
+	using T = typename Container::value_type;
+	auto centerPoint = std::accumulate(points.begin(), points.end(), T{ 0.0, 0.0, 0.0, 1.0 });
 	centerPoint = centerPoint / static_cast<double>(points.size());
 	return centerPoint;
 }
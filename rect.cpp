@@ -1,5 +1,7 @@
 #include "primitives.hpp"
 
+#include <algorithm>
+
 int Rect::bottom() const { return y + height; }
 int Rect::right() const { return x + width; }
 
@@ -7,3 +9,23 @@ Point Rect::center() const
 {
 	return Point((width / 2), (height / 2), 0, this, Color{ 0, 0, 0 });
 }
+
+Rect unite(const Rect& a, const Rect& b)
+{
+	auto x = std::min(a.x, b.x);
+	auto y = std::min(a.y, b.y);
+	return Rect{ x, y, std::max(a.right(), b.right()) - x, std::max(a.bottom(), b.bottom()) - y };
+}
+
+std::optional<Rect> intersect(const Rect& a, const Rect& b)
+{
+	auto x = std::max(a.x, b.x);
+	auto y = std::max(a.y, b.y);
+	auto right = std::min(a.right(), b.right());
+	auto bottom = std::min(a.bottom(), b.bottom());
+	if (right <= x || bottom <= y)
+	{
+		return std::nullopt;
+	}
+	return Rect{ x, y, right - x, bottom - y };
+}
@@ -0,0 +1,108 @@
+#include <cmath>
+
+#include "Check.hpp"
+#include "TestScenes.hpp"
+#include "../Animation.hpp"
+
+namespace
+{
+	// A translate keyed at frames 10 and 20, a rotate keyed at 10 and a camera keyed at 8
+	const auto KeyedScene = {
+		"camera -1 -1 1 1 1 100",
+		"key 8 -2 -2 2 2 1 100",
+		"{",
+		"translate 0 0 10",
+		"key 20 4 2 10",
+		"key 10 4 0 10",
+		"rotate Z 0",
+		"key 10 90",
+		"polygon -1 -1 0 0 1 0 1 -1 0",
+		"}"
+	};
+
+	std::size_t nodeOf(const SceneGraph& scene, SceneGraph::NodeType type, int skip = 0)
+	{
+		for (auto i = 0u; i < scene.nodes().size(); ++i)
+		{
+			if (scene.nodes()[i].type == type && skip-- == 0)
+			{
+				return i;
+			}
+		}
+		return scene.nodes().size();
+	}
+
+	// Where a node's world matrix takes a point
+	Vector4_t placed(const SceneGraph& scene, std::size_t node, const Vector4_t& point)
+	{
+		return scene.worldMatrix(node) * point;
+	}
+
+	bool near(double a, double b)
+	{
+		return std::abs(a - b) < 1e-9;
+	}
+}
+
+TEST_CASE(animationHoldsKeysAndInterpolatesBetween)
+{
+	SceneGraph scene(TestScenes::parse(KeyedScene));
+	Animation animation(scene);
+	CHECK(animation.frameCount() == 21);
+
+	auto translate = nodeOf(scene, SceneGraph::NodeType::Transform);
+	const Vector4_t origin{ 0, 0, 0, 1 };
+	struct Expected
+	{
+		double frame;
+		double x;
+		double y;
+	};
+	// The command is the key at frame 0, keys out of order are sorted, the last one holds
+	for (auto [frame, x, y] : { Expected{ 0, 0, 0 }, Expected{ 5, 2, 0 }, Expected{ 10, 4, 0 }, Expected{ 12.5, 4, 0.5 },
+								Expected{ 20, 4, 2 }, Expected{ 35, 4, 2 } })
+	{
+		animation.pose(scene, frame);
+		auto p = placed(scene, translate, origin);
+		CHECK(near(p[0], x) && near(p[1], y) && near(p[2], 10));
+	}
+}
+
+TEST_CASE(animationInterpolatesAnglesAndCameras)
+{
+	SceneGraph scene(TestScenes::parse(KeyedScene));
+	Animation animation(scene);
+	auto rotate = nodeOf(scene, SceneGraph::NodeType::Transform, 1);
+	auto camera = nodeOf(scene, SceneGraph::NodeType::Camera);
+
+	// Halfway to 90 degrees, the x axis lands on the diagonal
+	animation.pose(scene, 5);
+	auto axis = placed(scene, rotate, Vector4_t{ 1, 0, 0, 0 });
+	CHECK(near(std::abs(axis[0]), std::sqrt(0.5)) && near(std::abs(axis[1]), std::sqrt(0.5)));
+	CHECK(near(scene.cameraParams(camera).xLow, -1.625) && near(scene.cameraParams(camera).yHigh, 1.625));
+
+	animation.pose(scene, 10);
+	axis = placed(scene, rotate, Vector4_t{ 1, 0, 0, 0 });
+	CHECK(near(axis[0], 0) && near(std::abs(axis[1]), 1));
+	CHECK(near(scene.cameraParams(camera).xLow, -2) && near(scene.cameraParams(camera).far, 100));
+
+	animation.pose(scene, 0);
+	axis = placed(scene, rotate, Vector4_t{ 1, 0, 0, 0 });
+	CHECK(near(axis[0], 1) && near(axis[1], 0));
+	CHECK(near(scene.cameraParams(camera).xLow, -1));
+}
+
+TEST_CASE(animationRejectsKeysOfTheWrongSize)
+{
+	auto threw = false;
+	try
+	{
+		SceneGraph scene(TestScenes::parse({ "translate 0 0 10", "key 5 1 2" }));
+		Animation animation(scene);
+	}
+	catch (const std::invalid_argument&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+}
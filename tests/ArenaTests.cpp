@@ -0,0 +1,95 @@
+#include <cstdint>
+
+#include "Check.hpp"
+#include "../Arena.hpp"
+
+TEST_CASE(arenaRewindReusesMemory)
+{
+	Arena arena(256);
+	auto marker = arena.mark();
+	auto first = arena.allocate(64, 8);
+	arena.rewind(marker);
+	auto second = arena.allocate(64, 8);
+	CHECK(first == second);
+}
+
+TEST_CASE(arenaRewindAcrossBlocks)
+{
+	Arena arena(256);
+	auto first = arena.allocate(16, 8);
+	auto marker = arena.mark();
+	// Spill into later blocks
+	for (auto i = 0; i < 8; ++i)
+	{
+		arena.allocate(200, 8);
+	}
+	arena.rewind(marker);
+	auto next = static_cast<std::byte*>(arena.allocate(16, 8));
+	CHECK(next == static_cast<std::byte*>(first) + 16);
+}
+
+TEST_CASE(arenaScopeRewinds)
+{
+	Arena arena(256);
+	auto marker = arena.mark();
+	{
+		Arena::Scope scope(arena);
+		arena.allocate(100, 8);
+		arena.allocate(300, 8);
+	}
+	CHECK(arena.mark().block == marker.block);
+	CHECK(arena.mark().offset == marker.offset);
+}
+
+TEST_CASE(arenaAlignsLargeAllocations)
+{
+	Arena arena(64);
+	arena.allocate(3, 1);
+	auto pointer = arena.allocate(1000, 64);
+	CHECK(reinterpret_cast<std::uintptr_t>(pointer) % 64 == 0);
+}
+
+TEST_CASE(arenaVectorGrowsInPlace)
+{
+	Arena arena(1 << 16);
+	ArenaVector<int> values{ ArenaAllocator<int>(arena) };
+	for (auto i = 0; i < 1000; ++i)
+	{
+		values.push_back(i);
+	}
+	auto sum = 0;
+	for (auto value : values)
+	{
+		sum += value;
+	}
+	CHECK(sum == 999 * 1000 / 2);
+}
+
+TEST_CASE(arenaRewindFreesBlocksOverTheRetainedSize)
+{
+	Arena arena(256, 1024);
+	auto marker = arena.mark();
+	for (auto i = 0; i < 32; ++i)
+	{
+		arena.allocate(200, 8);
+	}
+	CHECK(arena.reservedSize() >= 32 * 200);
+	arena.rewind(marker);
+	CHECK(arena.reservedSize() <= 1024);
+	CHECK(arena.reservedSize() > 0);
+}
+
+TEST_CASE(arenaRewindFreesOversizedBlocks)
+{
+	Arena arena(256, 1024);
+	auto marker = arena.mark();
+	arena.allocate(16, 8);
+	{
+		Arena::Scope scope(arena);
+		arena.allocate(100000, 8);
+		CHECK(arena.reservedSize() >= 100000);
+	}
+	CHECK(arena.reservedSize() == 256);
+	arena.rewind(marker);
+	CHECK(arena.reservedSize() == 256);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <vector>
+
+// Just enough of a test framework for the headless checks. Tests register
+// themselves, a failed CHECK reports where it was and the test carries on.
+namespace Check
+{
+	struct Test
+	{
+		const char* name;
+		std::function<void()> body;
+	};
+
+	inline std::vector<Test>& tests()
+	{
+		static std::vector<Test> all;
+		return all;
+	}
+
+	inline int& failures()
+	{
+		static int count = 0;
+		return count;
+	}
+
+	struct Registrar
+	{
+		Registrar(const char* name, std::function<void()> body)
+		{
+			tests().push_back(Test{ name, std::move(body) });
+		}
+	};
+
+	inline void fail(const char* expression, const char* file, int line)
+	{
+		std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+		++failures();
+	}
+
+	// Runs every registered test, an exception fails the test it came out of
+	inline int runAll()
+	{
+		auto failedTests = 0;
+		for (auto& test : tests())
+		{
+			auto before = failures();
+			try
+			{
+				test.body();
+			}
+			catch (const std::exception& e)
+			{
+				std::fprintf(stderr, "%s: threw %s\n", test.name, e.what());
+				++failures();
+			}
+
+			auto passed = failures() == before;
+			failedTests += passed ? 0 : 1;
+			std::fprintf(stderr, "%s %s\n", passed ? "pass" : "FAIL", test.name);
+		}
+
+		std::fprintf(stderr, "%zu tests, %d failed\n", tests().size(), failedTests);
+		return failedTests == 0 ? 0 : 1;
+	}
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static Check::Registrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(expression) ((expression) ? (void)0 : Check::fail(#expression, __FILE__, __LINE__))
@@ -0,0 +1,191 @@
+#include <type_traits>
+#include <variant>
+
+#include "Check.hpp"
+#include "TestScenes.hpp"
+#include "../CommandStream.hpp"
+
+namespace
+{
+	bool samePoint(const Point4D& a, const Point4D& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w &&
+			   a.color.r == b.color.r && a.color.g == b.color.g && a.color.b == b.color.b;
+	}
+
+	bool sameColor(const Color& a, const Color& b)
+	{
+		return a.getColorChannels() == b.getColorChannels();
+	}
+
+	// Field by field, commands have no equality of their own
+	bool sameCommand(const Command& a, const Command& b)
+	{
+		if (a.operation() != b.operation() || a.parameters().index() != b.parameters().index())
+		{
+			return false;
+		}
+
+		return std::visit([&b](const auto& params)
+		{
+			using T = std::decay_t<decltype(params)>;
+			auto& other = std::get<T>(b.parameters());
+			if constexpr (std::is_same_v<T, PolygonParams> || std::is_same_v<T, LineParams>)
+			{
+				for (auto i = 0u; i < params.size(); ++i)
+				{
+					if (!samePoint(params[i], other[i]))
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+			else if constexpr (std::is_same_v<T, Point4D>)
+			{
+				return samePoint(params, other);
+			}
+			else if constexpr (std::is_same_v<T, Color>)
+			{
+				return sameColor(params, other);
+			}
+			else if constexpr (std::is_same_v<T, CameraParams>)
+			{
+				return params.xLow == other.xLow && params.yLow == other.yLow && params.xHigh == other.xHigh &&
+					   params.yHigh == other.yHigh && params.near == other.near && params.far == other.far;
+			}
+			else if constexpr (std::is_same_v<T, DepthParams>)
+			{
+				return params.near == other.near && params.far == other.far && sameColor(params.color, other.color);
+			}
+			else if constexpr (std::is_same_v<T, MultisampleParams>)
+			{
+				return params.sampleCount == other.sampleCount;
+			}
+			else if constexpr (std::is_same_v<T, KeyframeParams>)
+			{
+				return params.frame == other.frame && params.values == other.values;
+			}
+			else
+			{
+				return params == other;
+			}
+		}, a.parameters());
+	}
+
+	const auto EveryCommand = {
+		"camera -1 -1 1 1 0.5 100",
+		"ambient 0.2 0.4 0.6",
+		"depth 5 50 0.1 0.2 0.3",
+		"light 1 0.5 0.25 0.1 0.01",
+		"surface 0.9 0.8 0.7 0.3 12",
+		"phong", "gouraud", "flat",
+		"wire", "filled",
+		"aliased", "antialiased",
+		"msaa 4",
+		"crease 45",
+		"{",
+		"translate 1.5 -2 3",
+		"scale 2 2 2",
+		"rotate Y 22.5",
+		"key 12 1 2 3",
+		"polygon 0 0 0 1 0 0 0 1 0",
+		"polygon 0 0 0 1 0 0 1 0 0 0 1 0 0 1 0 0 0 1",
+		"line 0 0 0 5 5 5",
+		"line 0 0 0 1 1 1 5 5 5 0 0 1",
+		"v 1 2 3",
+		"v 1 2 3 0.5 0.5 0.5",
+		"vn 0 0 1",
+		"f 1 2 3",
+		"f 1//4 2//5 3//6",
+		"file \"cube\"",
+		"obj \"teapot\"",
+		"instance \"teapot\"",
+		"}"
+	};
+}
+
+TEST_CASE(commandStreamRoundTrip)
+{
+	ParseContext context;
+	std::vector<Command> parsed;
+	for (auto line : EveryCommand)
+	{
+		parsed.push_back(Command(TestScenes::tokenize(line), context));
+	}
+
+	CommandStream commands(parsed);
+	CHECK(commands.size() == parsed.size());
+	for (auto i = 0u; i < parsed.size(); ++i)
+	{
+		CHECK(commands.operation(i) == parsed[i].operation());
+		CHECK(sameCommand(commands[i], parsed[i]));
+	}
+}
+
+TEST_CASE(commandStreamReplace)
+{
+	auto commands = TestScenes::parse({ "{", "translate 1 2 3", "}" });
+	commands.replace(1, Command(Command::Operation::Scale, Vector3{ 4, 5, 6 }));
+	CHECK(commands.size() == 3);
+	CHECK(commands.operation(1) == Command::Operation::Scale);
+	CHECK(sameCommand(commands[1], Command(Command::Operation::Scale, Vector3{ 4, 5, 6 })));
+	CHECK(commands.operation(2) == Command::Operation::CloseBrace);
+}
+
+TEST_CASE(commandStreamKeepsFractionalAngles)
+{
+	auto commands = TestScenes::parse({ "rotate Z 22.5" });
+	auto params = std::get<RotateParams>(commands[0].parameters());
+	CHECK(params.first == Axis::Z);
+	CHECK(params.second == 22.5);
+}
+
+TEST_CASE(rotateRejectsUnknownAxis)
+{
+	auto rejected = false;
+	try
+	{
+		TestScenes::parse({ "rotate W 10" });
+	}
+	catch (const std::invalid_argument&)
+	{
+		rejected = true;
+	}
+	CHECK(rejected);
+	CHECK(std::get<RotateParams>(TestScenes::parse({ "rotate X 10" })[0].parameters()).first == Axis::X);
+}
+
+TEST_CASE(commandStreamReadsParamsInPlace)
+{
+	ParseContext context;
+	std::vector<Command> parsed;
+	for (auto line : EveryCommand)
+	{
+		parsed.push_back(Command(TestScenes::tokenize(line), context));
+	}
+
+	CommandStream commands(parsed);
+	for (auto i = 0u; i < parsed.size(); ++i)
+	{
+		auto view = commands.view(i);
+		CHECK(view.operation() == parsed[i].operation());
+		std::visit([&](const auto& params)
+		{
+			using T = std::decay_t<decltype(params)>;
+			CHECK(sameCommand(Command{ view.operation(), view.get<T>() }, parsed[i]));
+		}, parsed[i].parameters());
+	}
+
+	auto rejected = false;
+	try
+	{
+		// The first command is the camera
+		commands.get<Vector3>(0);
+	}
+	catch (const std::invalid_argument&)
+	{
+		rejected = true;
+	}
+	CHECK(rejected);
+}
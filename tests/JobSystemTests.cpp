@@ -0,0 +1,166 @@
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "Check.hpp"
+#include "../JobSystem.hpp"
+
+namespace
+{
+	// Jobs append their id as they run
+	struct Log
+	{
+		std::mutex mutex;
+		std::vector<TaskGraph::JobId_t> order;
+
+		void add(TaskGraph::JobId_t id)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			order.push_back(id);
+		}
+
+		std::size_t position(TaskGraph::JobId_t id) const
+		{
+			for (auto i = 0u; i < order.size(); ++i)
+			{
+				if (order[i] == id)
+				{
+					return i;
+				}
+			}
+			return order.size();
+		}
+	};
+}
+
+TEST_CASE(taskGraphRunsJobsAfterTheirDependencies)
+{
+	JobSystem jobSystem(4);
+	Log log;
+	TaskGraph graph;
+	std::vector<std::vector<TaskGraph::JobId_t>> dependencies;
+
+	// Fan out, fan in, then a chain, with a few independent roots
+	auto job = [&](std::vector<TaskGraph::JobId_t> after)
+	{
+		auto id = dependencies.size();
+		dependencies.push_back(after);
+		return graph.add("job " + std::to_string(id), [&log, id]() { log.add(id); }, after);
+	};
+	auto root = job({});
+	std::vector<TaskGraph::JobId_t> fan;
+	for (auto i = 0; i < 16; ++i)
+	{
+		fan.push_back(job({ root }));
+	}
+	auto join = job(fan);
+	auto chain = join;
+	for (auto i = 0; i < 8; ++i)
+	{
+		chain = job({ chain, fan[i] });
+	}
+	for (auto i = 0; i < 8; ++i)
+	{
+		job({});
+	}
+
+	// A graph can run again, every job once per run
+	for (auto run = 0; run < 3; ++run)
+	{
+		log.order.clear();
+		graph.run(jobSystem);
+		CHECK(log.order.size() == dependencies.size());
+		for (auto id = 0u; id < dependencies.size(); ++id)
+		{
+			for (auto dependency : dependencies[id])
+			{
+				CHECK(log.position(dependency) < log.position(id));
+			}
+		}
+	}
+}
+
+TEST_CASE(taskGraphRethrowsAndSkipsTheJobsLeft)
+{
+	JobSystem jobSystem(3);
+	std::atomic<int> ran{ 0 };
+	TaskGraph graph;
+	auto failing = graph.add("fails", []() { throw std::runtime_error("job failed"); });
+	auto after = graph.add("after", [&ran]() { ++ran; }, { failing });
+	graph.add("after that", [&ran]() { ++ran; }, { after });
+
+	auto threw = false;
+	try
+	{
+		graph.run(jobSystem);
+	}
+	catch (const std::runtime_error&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+	CHECK(ran == 0);
+
+	// The pool is still there for other graphs
+	TaskGraph next;
+	next.add("runs", [&ran]() { ++ran; });
+	next.run(jobSystem);
+	CHECK(ran == 1);
+}
+
+TEST_CASE(taskGraphRunsGraphsFromInsideJobs)
+{
+	// One worker, the job waiting on its inner graph has to run it itself
+	JobSystem jobSystem(1);
+	std::atomic<int> ran{ 0 };
+	TaskGraph graph;
+	graph.add("outer", [&]()
+	{
+		TaskGraph inner;
+		for (auto i = 0; i < 10; ++i)
+		{
+			inner.add("inner", [&ran]() { ++ran; });
+		}
+		inner.run(jobSystem);
+	});
+	graph.run(jobSystem);
+	CHECK(ran == 10);
+}
+
+TEST_CASE(parallelForVisitsEveryIndexOnce)
+{
+	JobSystem jobSystem(4);
+	for (auto count : { 0u, 1u, 7u, 1000u })
+	{
+		std::vector<std::atomic<int>> visits(count);
+		jobSystem.parallelFor(count, [&visits](std::size_t i) { ++visits[i]; }, "visit", 3);
+		auto once = 0u;
+		for (auto& v : visits)
+		{
+			once += v == 1 ? 1 : 0;
+		}
+		CHECK(once == count);
+	}
+}
+
+TEST_CASE(parallelForRethrows)
+{
+	JobSystem jobSystem(2);
+	auto threw = false;
+	try
+	{
+		jobSystem.parallelFor(100, [](std::size_t i)
+		{
+			if (i == 57)
+			{
+				throw std::out_of_range("index 57");
+			}
+		});
+	}
+	catch (const std::out_of_range&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+}
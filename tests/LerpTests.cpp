@@ -0,0 +1,105 @@
+#include <cmath>
+#include <stdexcept>
+
+#include "Check.hpp"
+#include "../lerp.hpp"
+
+TEST_CASE(fixedPointLerpHitsEndpoints)
+{
+	for (auto steps : { 1, 3, 7, 100, 1000 })
+	{
+		FixedPointLerp<2> lerp({ 10.25, -3.0 }, { -500.5, 700.75 }, steps);
+		CHECK(lerp[0] == 10.25);
+		CHECK(lerp[1] == -3.0);
+		for (auto i = 0; i < steps; ++i)
+		{
+			lerp.advance();
+		}
+		// One rounding of the delta per step at most
+		CHECK(std::abs(lerp[0] - -500.5) <= steps / 4294967296.0);
+		CHECK(std::abs(lerp[1] - 700.75) <= steps / 4294967296.0);
+	}
+}
+
+TEST_CASE(fixedPointLerpSplitsWholeAndFraction)
+{
+	FixedPointLerp<1> lerp({ -1.25 }, { 2.75 }, 4);
+	CHECK(lerp.whole(0) == -2);
+	CHECK(lerp.fraction(0) == 0.75);
+	lerp.advance();
+	CHECK(lerp.whole(0) == -1);
+	CHECK(lerp.fraction(0) == 0.75);
+}
+
+TEST_CASE(fixedPointLerpMatchesIncrementalLerp)
+{
+	FixedPointLerp<1> fixed({ 0.0 }, { 37.0 }, 91);
+	IncrementalLerp<double, 1> incremental({ 0.0 }, { 37.0 }, 91);
+	for (auto i = 0; i <= 91; ++i)
+	{
+		CHECK(std::abs(fixed[0] - incremental[0]) < 0.01);
+		fixed.advance();
+		incremental.advance();
+	}
+}
+
+TEST_CASE(fixedPointLerpKeepsLargeChannels)
+{
+	// Past the range of 16.16, where unclipped projected lines end up
+	FixedPointLerp<1> lerp({ -90000.5 }, { 250000.25 }, 8);
+	for (auto i = 0; i < 8; ++i)
+	{
+		lerp.advance();
+	}
+	CHECK(std::abs(lerp[0] - 250000.25) < 1e-6);
+	CHECK(lerp.whole(0) == 250000);
+}
+
+TEST_CASE(fixedPointLerpRejectsChannelsOutOfRange)
+{
+	auto threw = false;
+	try
+	{
+		FixedPointLerp<1> lerp({ 0.0 }, { 1e12 }, 10);
+	}
+	catch (const std::out_of_range&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+}
+
+TEST_CASE(fixedPointLerpRejectsStepsOutOfRange)
+{
+	// Both ends are in range, but one step spans twice the range
+	auto threw = false;
+	try
+	{
+		FixedPointLerp<1> lerp({ -2e9 }, { 2e9 }, 1);
+	}
+	catch (const std::out_of_range&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+
+	FixedPointLerp<1> lerp({ -2e9 }, { 2e9 }, 2);
+	lerp.advance();
+	CHECK(lerp[0] == 0.0);
+	lerp.advance();
+	CHECK(lerp[0] == 2e9);
+}
+
+TEST_CASE(steppedLerpMatchesDirectEvaluation)
+{
+	const auto begin = 12.5;
+	const auto end = -1e9;
+	const auto steps = 977;
+	SteppedLerp<1> lerp({ begin }, { end }, steps);
+	auto slope = (end - begin) / steps;
+	for (auto i = 0; i <= steps; ++i)
+	{
+		CHECK(lerp[0] == begin + i * slope);
+		lerp.advance();
+	}
+}
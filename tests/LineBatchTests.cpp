@@ -0,0 +1,121 @@
+#include <chrono>
+
+#include "Check.hpp"
+#include "TestScenes.hpp"
+#include "../LineBatch.hpp"
+
+namespace
+{
+	// A tilted grid in camera space with diagonals, every crossing an endpoint
+	// shared by up to six lines. The far corner runs past the viewport
+	LineBatch grid()
+	{
+		const auto size = 12u;
+		LineBatch batch;
+		for (auto i = 0u; i <= size; ++i)
+		{
+			for (auto j = 0u; j <= size; ++j)
+			{
+				auto color = FloatColor{ 1.0f, i / static_cast<float>(size), j / static_cast<float>(size) };
+				batch.vertices.push_back(Point4D{ -6.0 + i * 1.1, -5.0 + j * 0.9, 8.0 + i * 0.5 + j * 0.7, 1.0, color });
+			}
+		}
+
+		auto at = [size](unsigned i, unsigned j) { return static_cast<std::uint32_t>(i * (size + 1) + j); };
+		for (auto i = 0u; i <= size; ++i)
+		{
+			for (auto j = 0u; j <= size; ++j)
+			{
+				if (i < size)
+				{
+					batch.lines.push_back({ at(i, j), at(i + 1, j) });
+				}
+				if (j < size)
+				{
+					batch.lines.push_back({ at(i, j), at(i, j + 1) });
+				}
+				if (i < size && j < size)
+				{
+					batch.lines.push_back({ at(i, j), at(i + 1, j + 1) });
+					batch.lines.push_back({ at(i + 1, j), at(i, j + 1) });
+				}
+			}
+		}
+		return batch;
+	}
+
+	FrameBuffer render(const LineBatch& batch, RenderEngine::LineMode mode, bool batched)
+	{
+		FrameBuffer image(TestScenes::ViewPort);
+		RenderEngine engine(TestScenes::ViewPort, &image, Color{ 255, 255, 255 });
+		engine.SetCamera(Camera{ CTM_t{}, -1, 1, -1, 1, 1, 100 });
+		engine.SetLineMode(mode);
+		if (batched)
+		{
+			engine.RenderLines(batch);
+		}
+		else
+		{
+			for (auto& line : batch.lines)
+			{
+				engine.RenderLine(Line_t{ batch.vertices[line[0]], batch.vertices[line[1]] });
+			}
+		}
+		return image;
+	}
+
+	// A batch has to draw exactly what its lines drawn one at a time do
+	void checkBatch(RenderEngine::LineMode mode)
+	{
+		auto batch = grid();
+		auto batched = render(batch, mode, true);
+		CHECK(TestScenes::litPixels(batched) > 2000);
+		CHECK(TestScenes::differentPixels(batched, render(batch, mode, false)) == 0);
+	}
+}
+
+TEST_CASE(lineBatchMatchesSingleLines)
+{
+	checkBatch(RenderEngine::LineMode::Aliased);
+}
+
+TEST_CASE(antialiasedLineBatchMatchesSingleLines)
+{
+	checkBatch(RenderEngine::LineMode::Antialiased);
+}
+
+TEST_CASE(linesAreClippedAtTheNearPlane)
+{
+	// An end just in front of the eye used to project millions of pixels away
+	auto far = Point4D{ 1.0, 1.0, 10.0, 1.0, FloatColor{ 0.0f, 1.0f, 0.0f } };
+	for (auto mode : { RenderEngine::LineMode::Aliased, RenderEngine::LineMode::Antialiased })
+	{
+		for (auto nearZ : { 1e-5, -3.0 })
+		{
+			auto eye = Point4D{ -2.0, 0.5, nearZ, 1.0, FloatColor{ 1.0f, 0.0f, 0.0f } };
+			LineBatch crossing;
+			crossing.vertices = { eye, far };
+			crossing.lines = { { 0, 1 } };
+			auto start = std::chrono::steady_clock::now();
+			auto image = render(crossing, mode, false);
+			CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(50));
+			CHECK(TestScenes::differentPixels(image, render(crossing, mode, true)) == 0);
+			CHECK(TestScenes::litPixels(image) > 50);
+
+			// The same as the part in front of the near plane, z = 1, drawn on its own
+			auto t = (1.0 - far.z) / (eye.z - far.z);
+			auto color = far.color * (1.0 - t) + eye.color * t;
+			LineBatch inFront;
+			inFront.vertices = { Point4D{ far.x + t * (eye.x - far.x), far.y + t * (eye.y - far.y), 1.0, 1.0, color }, far };
+			inFront.lines = { { 0, 1 } };
+			CHECK(TestScenes::differentPixels(image, render(inFront, mode, false)) == 0);
+		}
+
+		// Wholly behind the eye, nothing is drawn
+		LineBatch behind;
+		behind.vertices = { Point4D{ -1.0, 0.0, 0.5, 1.0 }, Point4D{ 1.0, 0.0, -4.0, 1.0 } };
+		behind.lines = { { 0, 1 } };
+		CHECK(TestScenes::litPixels(render(behind, mode, false)) == 0);
+		CHECK(TestScenes::litPixels(render(behind, mode, true)) == 0);
+	}
+}
@@ -0,0 +1,50 @@
+#include <stdexcept>
+
+#include "Check.hpp"
+#include "../MeshBuilder.hpp"
+
+namespace
+{
+	MeshBuilder triangleBuilder()
+	{
+		MeshBuilder builder("triangle");
+		builder.addVertex(Point4D{ 0, 0, 0, 1 });
+		builder.addVertex(Point4D{ 1, 0, 0, 1 });
+		builder.addVertex(Point4D{ 0, 1, 0, 1 });
+		builder.addNormal(Point{ 0, 0, 1 });
+		return builder;
+	}
+
+	bool throwsOutOfRange(const FaceParam& face)
+	{
+		auto builder = triangleBuilder();
+		try
+		{
+			builder.addFace(face);
+		}
+		catch (const std::out_of_range&)
+		{
+			return true;
+		}
+		return false;
+	}
+}
+
+TEST_CASE(meshBuilderResolvesRelativeIndices)
+{
+	auto builder = triangleBuilder();
+	builder.addFace({ { -3, 0, -1 }, { -2, 0, -1 }, { -1, 0, -1 } });
+	auto mesh = builder.build();
+	CHECK(mesh.faces.size() == 1);
+	CHECK(mesh.faces[0].vertexIndices[0] == 0);
+	CHECK(mesh.faces[0].vertexIndices[2] == 2);
+}
+
+TEST_CASE(meshBuilderRejectsMissingVertices)
+{
+	CHECK(throwsOutOfRange({ { 1, 0, 0 }, { 2, 0, 0 }, { 4, 0, 0 } }));
+	CHECK(throwsOutOfRange({ { 0, 0, 0 }, { 1, 0, 0 }, { 2, 0, 0 } }));
+	CHECK(throwsOutOfRange({ { -4, 0, 0 }, { 1, 0, 0 }, { 2, 0, 0 } }));
+	CHECK(throwsOutOfRange({ { 1, 0, 2 }, { 2, 0, 0 }, { 3, 0, 0 } }));
+	CHECK(!throwsOutOfRange({ { 1, 0, 1 }, { 2, 0, 1 }, { 3, 0, 1 } }));
+}
@@ -0,0 +1,62 @@
+#include <stdexcept>
+
+#include "Check.hpp"
+#include "TestScenes.hpp"
+
+namespace
+{
+	const auto Before = {
+		"camera -1 -1 1 1 1 100",
+		"ambient 0.4 0.4 0.4",
+		"light 1 1 1 0.01 0.001",
+		"{",
+		"translate -3 0 10",
+		"surface 1 0 0",
+		"polygon -2 -2 0 0 2 0 2 -2 0",
+		"}"
+	};
+
+	const auto After = {
+		"{",
+		"translate 3 1 12",
+		"surface 0 1 0",
+		"polygon -2 -2 0 0 2 0 2 -2 0",
+		"}"
+	};
+}
+
+TEST_CASE(pipelinedRunThatThrowsLeavesTheEngineUsable)
+{
+	auto commands = TestScenes::parse(Before);
+	ParseContext context;
+	commands.push_back(Command(TestScenes::tokenize("instance \"missing\""), context));
+
+	FrameBuffer image(TestScenes::ViewPort);
+	SimpEngine engine(RenderEngine{ TestScenes::ViewPort, &image, Color{ 255, 255, 255 } });
+	auto threw = false;
+	try
+	{
+		engine.runCommandsPipelined(commands, 3);
+	}
+	catch (const std::invalid_argument&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+
+	// What came before the throw is drawn
+	FrameBuffer expected(TestScenes::ViewPort);
+	SimpEngine reference(RenderEngine{ TestScenes::ViewPort, &expected, Color{ 255, 255, 255 } });
+	reference.runCommands(TestScenes::parse(Before));
+	CHECK(TestScenes::litPixels(image) > 0);
+	CHECK(TestScenes::differentPixels(image, expected) == 0);
+
+	// Later runs draw straight away and through a new pipeline
+	engine.runCommands(TestScenes::parse(After));
+	reference.runCommands(TestScenes::parse(After));
+	CHECK(TestScenes::differentPixels(image, expected) == 0);
+
+	engine.runCommandsPipelined(TestScenes::parse(After), 2);
+	reference.runCommands(TestScenes::parse(After));
+	CHECK(TestScenes::differentPixels(image, expected) == 0);
+}
@@ -0,0 +1,92 @@
+#include "Check.hpp"
+#include "../PointGenerator.hpp"
+
+namespace
+{
+	const Rect Bounds{ 0, 0, 200, 200 };
+
+	// Capacity has to cover every point, growing would strand storage in the
+	// arena and at least double it. The bound is a little over the count, the
+	// spans of a fan overlap on shared edges
+	void checkReserved(std::initializer_list<Point4D> corners, bool samples)
+	{
+		Arena arena;
+		ArenaVector<Point4D> vertices(corners.begin(), corners.end(), arena);
+		ArenaVector<Point4D> points(arena);
+		ArenaVector<SampleCoverage> coverage(arena);
+		if (samples)
+		{
+			PointGenerator::generatePolygonSamples(vertices, Bounds, SampleOffsets_t{ { { 0.25, 0.25 }, { 0.75, 0.75 } } }, points, coverage);
+			CHECK(coverage.size() == points.size());
+			CHECK(coverage.capacity() < coverage.size() + coverage.size() / 10 + 1000);
+		}
+		else
+		{
+			PointGenerator::generatePolygonPoints(vertices, Bounds, points);
+		}
+		CHECK(!points.empty());
+		CHECK(points.capacity() >= points.size());
+		CHECK(points.capacity() < points.size() + points.size() / 10 + 1000);
+	}
+}
+
+TEST_CASE(polygonPointsAreReservedUpFront)
+{
+	for (auto samples : { false, true })
+	{
+		checkReserved({ Point4D{ 10.3, 10.7, 5, 1 }, Point4D{ 150.2, 60.1, 5, 1 }, Point4D{ 40.9, 190.4, 5, 1 } }, samples);
+		checkReserved({ Point4D{ 0, 0, 5, 1 }, Point4D{ 199, 0, 5, 1 }, Point4D{ 199, 199, 5, 1 }, Point4D{ 0, 199, 5, 1 } }, samples);
+		checkReserved({ Point4D{ 5.5, 3, 5, 1 }, Point4D{ 6, 190, 5, 1 }, Point4D{ 7.25, 100, 5, 1 } }, samples);
+	}
+}
+
+TEST_CASE(wireframePointsAreReservedUpFront)
+{
+	Arena arena;
+	auto corners = { Point4D{ 10.3, 10.7, 5, 1 }, Point4D{ 150.2, 60.1, 5, 1 }, Point4D{ 40.9, 190.4, 5, 1 } };
+	ArenaVector<Point4D> vertices(corners.begin(), corners.end(), arena);
+	ArenaVector<Point4D> points(arena);
+	PointGenerator::generateWireframePoints(vertices, Bounds, points);
+	CHECK(!points.empty());
+	CHECK(points.capacity() == points.size());
+}
+
+TEST_CASE(polygonPointsStayInsideBounds)
+{
+	Arena arena;
+	auto corners = { Point4D{ 10.3, 10.7, 5, 1 }, Point4D{ 150.2, 60.1, 5, 1 }, Point4D{ 40.9, 190.4, 5, 1 } };
+	ArenaVector<Point4D> vertices(corners.begin(), corners.end(), arena);
+	ArenaVector<Point4D> all(arena);
+	ArenaVector<Point4D> band(arena);
+	PointGenerator::generatePolygonPoints(vertices, Bounds, all);
+	PointGenerator::generatePolygonPoints(vertices, Rect{ 0, 70, 200, 40 }, band);
+
+	// The band gets the same points, in the same order, as a full run filtered afterwards
+	auto inBand = 0u;
+	for (auto& point : all)
+	{
+		if (point.y >= 70 && point.y < 110)
+		{
+			CHECK(inBand < band.size() && band[inBand].x == point.x && band[inBand].y == point.y && band[inBand].z == point.z);
+			++inBand;
+		}
+	}
+	CHECK(inBand > 0);
+	CHECK(inBand == band.size());
+	CHECK(band.capacity() < all.size() / 2);
+}
+
+TEST_CASE(longLinePointsStayNearBounds)
+{
+	// Far longer than an int can count, only the part over the bounds is walked
+	Arena arena;
+	ArenaVector<Point4D> points(arena);
+	PointGenerator::generateLinePoints(Point4D{ -1e12, 50, 5, 1 }, Point4D{ 1e12, 150, 5, 1 }, Bounds, points);
+	PointGenerator::generateLinePoints(Point4D{ 100, 1e12, 5, 1 }, Point4D{ 120, -1e12, 5, 1 }, Bounds, points);
+	CHECK(points.size() > 400);
+	CHECK(points.size() < 410);
+	for (auto& point : points)
+	{
+		CHECK(point.x >= -2 && point.x <= 202 && point.y >= -2 && point.y <= 202);
+	}
+}
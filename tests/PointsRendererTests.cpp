@@ -0,0 +1,49 @@
+#include <limits>
+
+#include "Check.hpp"
+#include "TestScenes.hpp"
+#include "../PointsRenderer.hpp"
+
+namespace
+{
+	using LineRenderer = void (*)(const Point4D&, const Point4D&, Drawable*, Matrix2D<double>&, const Rect&, const Camera&, const std::optional<DepthCue>&);
+
+	FrameBuffer drawLine(LineRenderer render, const Point4D& p1, const Point4D& p2)
+	{
+		FrameBuffer image(TestScenes::ViewPort);
+		auto zBuffer = Matrix2D<double>(TestScenes::ViewPort.width, std::vector<double>(TestScenes::ViewPort.height, std::numeric_limits<double>::max()));
+		auto camera = Camera{ CTM_t{}, -1, 1, -1, 1, 1, 100 };
+		render(p1, p2, &image, zBuffer, TestScenes::ViewPort, camera, std::nullopt);
+		return image;
+	}
+
+	// Pixels of a line that runs far past the viewport, against the same line
+	// ending on screen. Left of the short line's end they have to match
+	void checkLongLine(LineRenderer render)
+	{
+		auto color = FloatColor{ 1.0f, 1.0f, 1.0f };
+		auto shortLine = drawLine(render, Point4D{ 10, 20, 5, 1, color }, Point4D{ 190, 110, 5, 1, color });
+		auto longLine = drawLine(render, Point4D{ 10, 20, 5, 1, color }, Point4D{ 10 + 2e12, 20 + 1e12, 5, 1, color });
+
+		auto different = 0;
+		for (auto y = 0; y < shortLine.height(); ++y)
+		{
+			for (auto x = 0; x < 190; ++x)
+			{
+				different += shortLine.data()[y * shortLine.width() + x] != longLine.data()[y * longLine.width() + x] ? 1 : 0;
+			}
+		}
+		CHECK(TestScenes::litPixels(shortLine) > 150);
+		CHECK(different == 0);
+	}
+}
+
+TEST_CASE(renderLineWalksOnlyTheViewport)
+{
+	checkLongLine(PointsRenderer::renderLine);
+}
+
+TEST_CASE(renderAntialiasedLineWalksOnlyTheViewport)
+{
+	checkLongLine(PointsRenderer::renderAntialiasedLine);
+}
@@ -0,0 +1,179 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../RenderingEngine.hpp"
+#include "../SceneGraph.hpp"
+#include "../SequenceRenderer.hpp"
+#include "../SimpEngine.hpp"
+#include "../SimpFile.hpp"
+
+// Renders SIMP scenes headless and checks that every way of running one draws
+// the same image: immediate, streamed while includes load, pipelined,
+// retained, and through a scene graph. Images can be written out and compared against a run of another
+// build, e.g. before and after a change.
+//
+// RenderCompare [--out dir] [--against dir] scene.simp...
+namespace
+{
+	const Rect ViewPort{ 0, 0, 650, 650 };
+
+	using Render = std::function<void(const RenderEngine& renderEngine, const SimpFile& file)>;
+
+	FrameBuffer render(const SimpFile& file, const Render& run)
+	{
+		FrameBuffer image(ViewPort);
+		run(RenderEngine{ ViewPort, &image, Color{ 255, 255, 255 } }, file);
+		return image;
+	}
+
+	int differentPixels(const std::vector<unsigned int>& a, const std::vector<unsigned int>& b)
+	{
+		if (a.size() != b.size())
+		{
+			return static_cast<int>(std::max(a.size(), b.size()));
+		}
+
+		// Images read back have no alpha
+		auto count = 0;
+		for (auto i = 0u; i < a.size(); ++i)
+		{
+			count += (a[i] & 0xffffff) != (b[i] & 0xffffff) ? 1 : 0;
+		}
+		return count;
+	}
+
+	bool writePPM(const std::string& fileName, const FrameBuffer& image)
+	{
+		std::ofstream stream(fileName, std::ios::binary);
+		if (!stream)
+		{
+			return false;
+		}
+
+		stream << "P6 " << image.width() << " " << image.height() << " 255\n";
+		for (auto color : image.data())
+		{
+			char rgb[3] = { static_cast<char>((color >> 16) & 0xff), static_cast<char>((color >> 8) & 0xff), static_cast<char>(color & 0xff) };
+			stream.write(rgb, 3);
+		}
+		return static_cast<bool>(stream);
+	}
+
+	std::optional<std::vector<unsigned int>> readPPM(const std::string& fileName)
+	{
+		std::ifstream stream(fileName, std::ios::binary);
+		std::string magic;
+		int width, height, maxValue;
+		if (!(stream >> magic >> width >> height >> maxValue) || magic != "P6")
+		{
+			return std::nullopt;
+		}
+		stream.get();
+
+		std::vector<unsigned int> pixels(static_cast<std::size_t>(width) * height);
+		for (auto& pixel : pixels)
+		{
+			unsigned char rgb[3];
+			stream.read(reinterpret_cast<char*>(rgb), 3);
+			pixel = (rgb[0] << 16) | (rgb[1] << 8) | rgb[2];
+		}
+		return pixels;
+	}
+
+	std::string baseName(const std::string& path)
+	{
+		auto start = path.find_last_of("/\\");
+		auto name = start == std::string::npos ? path : path.substr(start + 1);
+		return name.substr(0, name.rfind('.'));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string outDirectory;
+	std::string againstDirectory;
+	std::vector<std::string> scenes;
+	for (auto i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+		{
+			outDirectory = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--against") == 0 && i + 1 < argc)
+		{
+			againstDirectory = argv[++i];
+		}
+		else
+		{
+			scenes.push_back(argv[i]);
+		}
+	}
+
+	const std::vector<std::pair<const char*, Render>> variants = {
+		{ "runFile", [](const RenderEngine& renderEngine, const SimpFile& file) { SimpEngine(renderEngine).runFile(file); } },
+		{ "pipelined", [](const RenderEngine& renderEngine, const SimpFile& file) { SimpEngine(renderEngine).runCommandsPipelined(file.commands(), 3); } },
+		{ "retained", [](const RenderEngine& renderEngine, const SimpFile& file) { SimpEngine(renderEngine).retainCommands(file.commands()); } },
+		{ "sceneGraph", [](const RenderEngine& renderEngine, const SimpFile& file)
+		{
+			auto engine = renderEngine;
+			SceneGraph(file.commands()).render(engine);
+		} }
+	};
+
+	auto failures = 0;
+	for (auto& scene : scenes)
+	{
+		auto name = baseName(scene);
+		try
+		{
+			SimpFile file(scene);
+			auto reference = render(file, [](const RenderEngine& renderEngine, const SimpFile& file) { SimpEngine(renderEngine).runCommands(file.commands()); });
+
+			std::string result = "ok";
+			for (auto& [variant, run] : variants)
+			{
+				auto diff = differentPixels(reference.data(), render(file, run).data());
+				if (diff != 0)
+				{
+					result = std::string(variant) + " differs in " + std::to_string(diff) + " pixels";
+					++failures;
+				}
+			}
+
+			if (!againstDirectory.empty())
+			{
+				auto expected = readPPM(againstDirectory + "/" + name + ".ppm");
+				if (!expected)
+				{
+					result += ", no image to compare against";
+				}
+				else if (auto diff = differentPixels(reference.data(), *expected); diff != 0)
+				{
+					result += ", " + std::to_string(diff) + " pixels differ from " + againstDirectory;
+					++failures;
+				}
+			}
+
+			if (!outDirectory.empty() && !writePPM(outDirectory + "/" + name + ".ppm", reference))
+			{
+				result += ", could not write to " + outDirectory;
+				++failures;
+			}
+
+			std::fprintf(stderr, "%s: %s\n", name.c_str(), result.c_str());
+		}
+		catch (const std::exception& e)
+		{
+			// Scenes whose models are not shipped
+			std::fprintf(stderr, "%s: skipped, %s\n", name.c_str(), e.what());
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}
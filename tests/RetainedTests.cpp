@@ -0,0 +1,151 @@
+#include "Check.hpp"
+#include "TestScenes.hpp"
+
+using namespace std::string_literals;
+
+namespace
+{
+	const auto Scene = {
+		"camera -1 -1 1 1 1 100",
+		"ambient 0.4 0.4 0.4",
+		"light 1 1 1 0.01 0.001",
+		"{",
+		"translate -4 0 10",
+		"surface 1 0 0",
+		"polygon -2 -2 0 0 2 0 2 -2 0",
+		"}",
+		"{",
+		"translate 4 1 12",
+		"surface 0 1 0",
+		"polygon -2 -2 0 0 2 0 2 -2 0",
+		"polygon -2 2 1 2 2 1 0 -2 1",
+		"}",
+		"{",
+		"translate 0 -4 14",
+		"wire",
+		"polygon -3 -1 0 0 2 0 3 -1 0",
+		"}"
+	};
+
+	// An obj include the way a file parse leaves it, then an instance of it,
+	// seen from a camera placed inside a block
+	CommandStream meshScene()
+	{
+		auto commands = TestScenes::parse({
+			"{",
+			"translate 0 0 -1",
+			"camera -1 -1 1 1 1 100",
+			"}",
+			"ambient 0.4 0.4 0.4",
+			"light 1 1 1 0.01 0.001",
+			"{",
+			"translate -4 0 10",
+			"obj \"tri\"",
+			"v -2 -2 0",
+			"v 0 2 0",
+			"v 2 -2 0",
+			"f 1 2 3"
+		});
+		commands.push_back(Command{ Command::Operation::ObjectFile, "ENDOFOBJECTFILE"s });
+		for (auto command : TestScenes::parse({
+			"}",
+			"{",
+			"translate 4 1 12",
+			"instance \"tri\"",
+			"}",
+			"{",
+			"translate 0 -4 14",
+			"surface 0 1 0",
+			"polygon -2 -2 0 0 2 0 2 -2 0",
+			"}" }))
+		{
+			commands.push_back(command);
+		}
+		return commands;
+	}
+
+	// Multisampling switched on part way, after the first block
+	const auto MultisampleScene = {
+		"camera -1 -1 1 1 1 100",
+		"ambient 0.4 0.4 0.4",
+		"light 1 1 1 0.01 0.001",
+		"{",
+		"translate -1 0 10",
+		"surface 1 0 0",
+		"polygon -3 -2 0 0 2.5 0 3 -2 0",
+		"}",
+		"msaa 4",
+		"{",
+		"translate 1 0.5 11",
+		"surface 0 1 0",
+		"polygon -2 -2 0 0 3 0 2 -3 0",
+		"}"
+	};
+
+	// Applies an edit in retained mode, then checks the redraw against the
+	// edited scene rendered from scratch
+	void checkEdit(CommandStream commands, std::size_t index, const Command& edit)
+	{
+		FrameBuffer retained(TestScenes::ViewPort);
+		SimpEngine engine(RenderEngine{ TestScenes::ViewPort, &retained, Color{ 255, 255, 255 } });
+		engine.retainCommands(commands);
+		CHECK(TestScenes::litPixels(retained) > 0);
+		CHECK(TestScenes::differentPixels(retained, TestScenes::render(commands)) == 0);
+
+		engine.replaceCommand(index, edit);
+		engine.renderChanges();
+
+		commands.replace(index, edit);
+		auto full = TestScenes::render(commands);
+		CHECK(TestScenes::litPixels(full) > 0);
+		CHECK(TestScenes::differentPixels(retained, full) == 0);
+	}
+}
+
+TEST_CASE(retainedMoveMatchesFullRender)
+{
+	checkEdit(TestScenes::parse(Scene), 9, Command(Command::Operation::Translate, Vector3{ -1, -2, 11 }));
+}
+
+TEST_CASE(retainedGeometryEditMatchesFullRender)
+{
+	ParseContext context;
+	checkEdit(TestScenes::parse(Scene), 12, Command(TestScenes::tokenize("polygon -3 -3 0 0 3 0 3 -3 0"), context));
+}
+
+TEST_CASE(retainedSettingEditMatchesFullRender)
+{
+	checkEdit(TestScenes::parse(Scene), 1, Command(Command::Operation::Ambient, Color::getDenormalizedColor(0.9, 0.1, 0.1)));
+}
+
+TEST_CASE(retainedMoveOffScreenMatchesFullRender)
+{
+	checkEdit(TestScenes::parse(Scene), 4, Command(Command::Operation::Translate, Vector3{ -400, 0, 10 }));
+}
+
+TEST_CASE(retainedInstanceMoveMatchesFullRender)
+{
+	checkEdit(meshScene(), 16, Command(Command::Operation::Translate, Vector3{ 3, 2, 12 }));
+}
+
+TEST_CASE(retainedMeshMoveMatchesFullRender)
+{
+	checkEdit(meshScene(), 7, Command(Command::Operation::Translate, Vector3{ -3, -1, 10 }));
+}
+
+TEST_CASE(retainedMeshEditMatchesFullRender)
+{
+	ParseContext context;
+	checkEdit(meshScene(), 10, Command(TestScenes::tokenize("v 0 3 0"), context));
+}
+
+TEST_CASE(retainedMoveAwayFromMeshesMatchesFullRender)
+{
+	checkEdit(meshScene(), 20, Command(Command::Operation::Translate, Vector3{ 0, -5, 14 }));
+}
+
+TEST_CASE(retainedEditBeforeMultisamplingMatchesFullRender)
+{
+	// The redraw starts over without samples, as the first run did
+	checkEdit(TestScenes::parse(MultisampleScene), 4, Command(Command::Operation::Translate, Vector3{ -1.5, 0.5, 10 }));
+}
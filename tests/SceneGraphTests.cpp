@@ -0,0 +1,102 @@
+#include "Check.hpp"
+#include "TestScenes.hpp"
+#include "../SceneGraph.hpp"
+
+namespace
+{
+	// A row of blocks, a panned camera sees some whole, one cut by the edge of
+	// the viewport and the rest not at all. Nothing but transforms and geometry
+	// in the blocks, so every one of them can be culled
+	const auto PannedScene = {
+		"{",
+		"translate 6 0 0",
+		"camera -0.5 -0.5 0.5 0.5 1 100",
+		"}",
+		"ambient 0.4 0.4 0.4",
+		"light 1 1 1 0.01 0.001",
+		"surface 1 0.5 0",
+		"{",
+		"translate -12 0 15",
+		"polygon -2 -2 0 0 2 0 2 -2 0",
+		"}",
+		"{",
+		"translate -6 0 15",
+		"polygon -2 -2 0 0 2 0 2 -2 0",
+		"}",
+		"{",
+		"translate 0 0 15",
+		"polygon -2 -2 0 0 2 0 2 -2 0",
+		"}",
+		"{",
+		"translate 6 1 15",
+		"polygon -2 -2 0 0 2 0 2 -2 0",
+		"}",
+		"{",
+		"translate 11 -1 15",
+		"polygon -2 -2 0 0 2 0 2 -2 0",
+		"}"
+	};
+
+	FrameBuffer renderGraph(const SceneGraph& graph, const std::optional<Camera>& camera)
+	{
+		FrameBuffer image(TestScenes::ViewPort);
+		RenderEngine engine{ TestScenes::ViewPort, &image, Color{ 255, 255, 255 } };
+		if (camera.has_value())
+		{
+			graph.render(engine, *camera);
+		}
+		else
+		{
+			graph.render(engine);
+		}
+		return image;
+	}
+}
+
+TEST_CASE(cullingAPannedViewKeepsEveryPixel)
+{
+	auto commands = TestScenes::parse(PannedScene);
+	SceneGraph graph(commands);
+	auto reference = TestScenes::render(commands);
+	CHECK(TestScenes::litPixels(reference) > 1000);
+
+	// runCommands draws every block, the graph skips the ones out of view
+	CHECK(TestScenes::differentPixels(renderGraph(graph, std::nullopt), reference) == 0);
+	CHECK(TestScenes::differentPixels(renderGraph(graph, graph.camera()), reference) == 0);
+
+	// The block at the left edge is cut, not culled
+	auto edge = 0;
+	for (auto y = 0; y < TestScenes::ViewPort.height; ++y)
+	{
+		edge += reference.data()[y * TestScenes::ViewPort.width] != 0 ? 1 : 0;
+	}
+	CHECK(edge > 0);
+}
+
+TEST_CASE(multipleViewsMatchSingleViews)
+{
+	SceneGraph graph(TestScenes::parse(PannedScene));
+	std::vector<Camera> views;
+	for (auto pan : { -8.0, 0.0, 6.0, 30.0 })
+	{
+		views.push_back(SceneGraph::cameraFrom(SceneGraph::translateMatrix(Vector3{ pan, 0.5, 0 }), CameraParams{ -0.5, -0.5, 0.5, 0.5, 1, 100 }));
+	}
+
+	// Drawn together, each view into its own image
+	std::vector<FrameBuffer> images(views.size(), FrameBuffer(TestScenes::ViewPort));
+	std::vector<RenderEngine> engines;
+	for (auto& image : images)
+	{
+		engines.emplace_back(TestScenes::ViewPort, &image, Color{ 255, 255, 255 });
+	}
+	graph.render(engines, views);
+
+	for (auto i = 0u; i < views.size(); ++i)
+	{
+		auto single = renderGraph(graph, views[i]);
+		CHECK(TestScenes::differentPixels(images[i], single) == 0);
+	}
+	CHECK(TestScenes::litPixels(images[0]) > 1000);
+	CHECK(TestScenes::litPixels(images[3]) == 0);
+	CHECK(TestScenes::differentPixels(images[0], images[2]) > 1000);
+}
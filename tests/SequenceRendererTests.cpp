@@ -0,0 +1,60 @@
+#include "Check.hpp"
+#include "TestScenes.hpp"
+#include "../Animation.hpp"
+
+namespace
+{
+	// A square sliding right over the frames while the camera backs away
+	const auto SlidingScene = {
+		"camera -1 -1 1 1 1 100",
+		"key 30 -1.5 -1.5 1.5 1.5 1 100",
+		"ambient 0.5 0.5 0.5",
+		"surface 0.2 0.6 1",
+		"{",
+		"translate -4 0 10",
+		"key 30 4 1 12",
+		"polygon -2 -2 0 -2 2 0 2 2 0",
+		"polygon -2 -2 0 2 2 0 2 -2 0",
+		"}"
+	};
+
+	// Frames as the sink sees them, next to the frame posed and drawn alone
+	void checkFrames(int first, int last)
+	{
+		SceneGraph scene(TestScenes::parse(SlidingScene));
+		Animation animation(scene);
+
+		std::vector<int> order;
+		auto matching = 0;
+		SequenceRenderer::render(scene, animation, TestScenes::ViewPort, first, last, [&](int frame, const FrameBuffer& image)
+		{
+			order.push_back(frame);
+
+			auto posed = scene;
+			animation.pose(posed, frame);
+			FrameBuffer single(TestScenes::ViewPort);
+			RenderEngine engine{ TestScenes::ViewPort, &single, Color{ 255, 255, 255 } };
+			posed.render(engine);
+			matching += TestScenes::litPixels(image) > 0 && TestScenes::differentPixels(image, single) == 0 ? 1 : 0;
+		});
+
+		CHECK(static_cast<int>(order.size()) == last - first + 1);
+		for (auto i = 0u; i < order.size(); ++i)
+		{
+			CHECK(order[i] == first + static_cast<int>(i));
+		}
+		CHECK(matching == last - first + 1);
+	}
+}
+
+TEST_CASE(sequenceFramesArriveInOrder)
+{
+	// Longer than one window of frames in flight
+	checkFrames(0, 2 * JobSystem::shared().workerCount() + 5);
+}
+
+TEST_CASE(sequenceFramesSplitIntoBandsMatch)
+{
+	// Fewer frames than cores, each is drawn in bands
+	checkFrames(12, 13);
+}
@@ -0,0 +1,37 @@
+#include <cmath>
+
+#include "Check.hpp"
+#include "../SpecularTable.hpp"
+
+namespace
+{
+	// Largest gap between the table and pow, sampled finer than any table
+	double worstError(const SpecularTable& table)
+	{
+		auto worst = 0.0;
+		for (auto i = 0; i <= 1000000; ++i)
+		{
+			auto x = i / 1000000.0;
+			auto error = std::abs(table.lookup(static_cast<float>(x)) - std::pow(static_cast<float>(x), table.exponent()));
+			worst = std::max(worst, error);
+		}
+		return worst;
+	}
+}
+
+TEST_CASE(specularTableStaysUnderHalfAColorStep)
+{
+	for (auto exponent : { 1.0, 4.0, 50.0, 1000.0, 20000.0 })
+	{
+		CHECK(worstError(SpecularTable(exponent)) < 0.5 / 255.0);
+	}
+}
+
+TEST_CASE(specularTableHitsEndpoints)
+{
+	SpecularTable table(1000.0);
+	CHECK(table.lookup(0.0f) == 0.0f);
+	CHECK(table.lookup(1.0f) == 1.0f);
+	CHECK(table.lookup(-0.5f) == 0.0f);
+	CHECK(table.lookup(1.5f) == 1.0f);
+}
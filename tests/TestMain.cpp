@@ -0,0 +1,6 @@
+#include "Check.hpp"
+
+int main()
+{
+	return Check::runAll();
+}
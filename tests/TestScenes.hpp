@@ -0,0 +1,67 @@
+#pragma once
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../command.hpp"
+#include "../CommandStream.hpp"
+#include "../RenderingEngine.hpp"
+#include "../SequenceRenderer.hpp"
+#include "../SimpEngine.hpp"
+
+// Small scenes written inline, tokens are separated by whitespace only
+namespace TestScenes
+{
+	inline const Rect ViewPort{ 0, 0, 200, 200 };
+
+	inline std::vector<std::string> tokenize(const char* line)
+	{
+		std::istringstream stream(line);
+		std::vector<std::string> tokens;
+		for (std::string token; stream >> token;)
+		{
+			tokens.push_back(token);
+		}
+		return tokens;
+	}
+
+	inline CommandStream parse(std::initializer_list<const char*> lines)
+	{
+		CommandStream commands;
+		ParseContext context;
+		for (auto line : lines)
+		{
+			commands.push_back(Command(tokenize(line), context));
+		}
+		return commands;
+	}
+
+	inline FrameBuffer render(const CommandStream& commands)
+	{
+		FrameBuffer image(ViewPort);
+		SimpEngine engine(RenderEngine{ ViewPort, &image, Color{ 255, 255, 255 } });
+		engine.runCommands(commands);
+		return image;
+	}
+
+	inline int differentPixels(const FrameBuffer& a, const FrameBuffer& b)
+	{
+		auto count = 0;
+		for (auto i = 0u; i < a.data().size(); ++i)
+		{
+			count += a.data()[i] != b.data()[i] ? 1 : 0;
+		}
+		return count;
+	}
+
+	inline int litPixels(const FrameBuffer& image)
+	{
+		auto count = 0;
+		for (auto pixel : image.data())
+		{
+			count += pixel != 0 ? 1 : 0;
+		}
+		return count;
+	}
+}
@@ -0,0 +1,39 @@
+#!/bin/sh
+# Builds the headless tests with the host compiler and runs them. The renderer
+# is compiled without the Qt front end.
+#
+# tests/run_tests.sh [RenderCompare options] [scene.simp...]
+# With no scenes every scene under simp/ is compared.
+set -e
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+build=$root/_test_build
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:-"-std=c++17 -O2 -pthread"}
+
+mkdir -p "$build/obj" "$build/scenes"
+
+objects=""
+for source in "$root"/*.cpp; do
+	case $(basename "$source") in
+		main.cpp|client.cpp|window361.cpp|renderarea361.cpp|assignment1.cpp|assignment2.cpp|assignment3.cpp|lineRenderer.cpp|polygonRenderer.cpp) continue ;;
+	esac
+	object=$build/obj/$(basename "$source" .cpp).o
+	if [ ! -f "$object" ] || [ "$source" -nt "$object" ] || [ -n "$(find "$root" -maxdepth 1 \( -name '*.hpp' -o -name '*.h' \) -newer "$object")" ]; then
+		$CXX $CXXFLAGS -I"$root" -c "$source" -o "$object"
+	fi
+	objects="$objects $object"
+done
+
+$CXX $CXXFLAGS -I"$root" "$root"/tests/TestMain.cpp "$root"/tests/*Tests.cpp $objects -o "$build/UnitTests"
+$CXX $CXXFLAGS -I"$root" "$root"/tests/RenderCompare.cpp $objects -o "$build/RenderCompare"
+
+"$build/UnitTests"
+
+# Scenes name their includes relative to the working directory
+cp "$root"/simp/*.simp "$root"/*.obj "$build/scenes"
+cd "$build/scenes"
+if [ "$#" -eq 0 ] || [ -z "$(for argument in "$@"; do case $argument in *.simp) echo x ;; esac; done)" ]; then
+	set -- "$@" *.simp
+fi
+"$build/RenderCompare" "$@"
@@ -1,5 +1,8 @@
 #include "primitives.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+
 Triangle::Triangle(const std::array<Point, 3>& vertices, const Rect* parent) : _vertices(vertices), _parent(parent)
 {
 	std::for_each(_vertices.begin(), _vertices.end(), [parent](auto& vertex) {vertex.parent = parent; });